@@ -40,6 +40,7 @@ OF SUCH DAMAGE.
 #include <math.h>
 #include <time.h>
 #include <gsl/gsl_rng.h>
+#include <gsl/gsl_cdf.h>
 #include <libxml/parser.h>
 #include <glib.h>
 #include "config.h"
@@ -48,15 +49,85 @@ OF SUCH DAMAGE.
 #include "method.h"
 #include "runge-kutta.h"
 #include "multi-steps.h"
+#include "sample.h"
+#include "statistics.h"
+#include "level.h"
+#include "scheduler.h"
+#include "queue.h"
+#include "profile.h"
 
 #define DEBUG_BALLISTIC 0       ///< macro to debug the ballistic functions.
+#define SEQUENTIAL_MIN 32
+///< minimum number of trajectories of a sequential sampling level.
+#define MLMC_PILOT 32
+///< number of pilot trajectories of a multilevel Monte Carlo level.
 
 long double convergence_factor;
 ///< convergence factor.
 unsigned int ntrajectories;
 ///< number of projectil trajectories to calculate.
+long double relative_precision;
+///< relative precision of the RMS position error (0: fixed sampling).
+long double confidence_z;
+///< standard normal quantile of the confidence level.
+long double min_order;
+///< minimum observed order to continue the convergence analysis.
+long double target_error;
+///< RMS position error to stop the convergence analysis (0: no target).
+long double error_max;
+///< maximum RMS position error of the target driven levels.
+unsigned int decade_points;
+///< number of target driven levels by decade (0: geometric levels).
+long double mlmc_error;
+///< standard error of the multilevel Monte Carlo estimate (0: disabled).
+unsigned int control_variate;
+///< analytical surrogate model type of the control variate (0: disabled).
+unsigned int control_trajectories;
+///< number of numerically calculated trajectories with a control variate.
 unsigned int convergence;
 ///< number of convergence steps.
+unsigned int cost_trajectories;
+///< number of the most expensive trajectories by level (0: no costs file).
+unsigned int shard;
+///< 1 on writing the partial results on a shard file, 0 otherwise.
+unsigned int nthreads;
+///< number of threads calculating the trajectories of a level.
+unsigned int integration_threads;
+///< number of integration threads of the first level pipeline (0: disabled).
+unsigned int reference_threads;
+///< number of reference solution threads of the first level pipeline.
+
+/**
+ * \struct Pipeline
+ * \brief struct to define the shared data of the first level pipeline.
+ */
+typedef struct
+{
+  Queue integration[1];         ///< queue of trajectories to integrate.
+  Queue reference[1];           ///< queue of trajectories to solve analytically.
+  long double *result;
+  ///< array of numerical solutions (position and velocity by trajectory).
+  unsigned char *done;          ///< array of finished stages by trajectory.
+  Sample *s;                    ///< Sample struct.
+} Pipeline;
+
+/**
+ * \struct Worker
+ * \brief struct to define the data of a thread calculating trajectories.
+ */
+typedef struct
+{
+  Level level[1];               ///< partial results of the level.
+  Equation eq[1];               ///< Equation struct of the thread.
+  RungeKutta rk[1];             ///< RungeKutta struct of the thread.
+  MultiSteps ms[1];             ///< MultiSteps struct of the thread.
+  Sample *s;                    ///< Sample struct.
+  Scheduler *scheduler;         ///< Scheduler struct.
+  Pipeline *pipeline;           ///< Pipeline struct.
+  long double t;                ///< final time of the last trajectory.
+  int me;                       ///< method type (1: Runge-Kutta, 2: multi-steps).
+  unsigned int thread;          ///< thread number.
+} Worker;
 
 /**
  * Function to read the basic input data.
@@ -69,8 +140,18 @@ convergence_read_xml (xmlNode * node)      ///< XML node.
 	const char *message[] = {
 		"Bad trajectories number",
 		"Bad convergence steps",
-		"Bad convergence factor"
+		"Bad convergence factor",
+		"Bad relative precision",
+		"Bad confidence level",
+		"Bad minimum order",
+		"Bad target error",
+		"Bad error range",
+		"Bad multilevel Monte Carlo error",
+		"Bad control variate",
+		"Bad threads number",
+		"Bad cost trajectories"
 	};
+  long double confidence;
 	int e, error_code;
 
 #if DEBUG_BALLISTIC
@@ -94,6 +175,115 @@ convergence_read_xml (xmlNode * node)      ///< XML node.
 			e = 2;
       goto fail;
 		}
+  relative_precision
+    = xml_node_get_float_with_default (node, XML_RELATIVE_PRECISION, 0.L,
+                                       &error_code);
+  if (error_code || relative_precision < 0.L)
+    {
+      e = 3;
+      goto fail;
+    }
+  confidence
+    = xml_node_get_float_with_default (node, XML_CONFIDENCE, 0.95L,
+                                       &error_code);
+  if (error_code || confidence <= 0.L || confidence >= 1.L)
+    {
+      e = 4;
+      goto fail;
+    }
+  confidence_z = gsl_cdf_ugaussian_Pinv (0.5 * (1. + confidence));
+  min_order = xml_node_get_float_with_default (node, XML_MIN_ORDER, 0.1L,
+                                               &error_code);
+  if (error_code)
+    {
+      e = 5;
+      goto fail;
+    }
+  target_error
+    = xml_node_get_float_with_default (node, XML_TARGET_ERROR, 0.L,
+                                       &error_code);
+  if (error_code || target_error < 0.L)
+    {
+      e = 6;
+      goto fail;
+    }
+  decade_points = xml_node_get_uint_with_default (node, XML_DECADE_POINTS, 0,
+                                                  &error_code);
+  if (error_code)
+    {
+      e = 7;
+      goto fail;
+    }
+  if (decade_points)
+    {
+      error_max = xml_node_get_float (node, XML_ERROR_MAX, &error_code);
+      if (error_code || error_max <= target_error)
+        {
+          e = 7;
+          goto fail;
+        }
+    }
+  mlmc_error = xml_node_get_float_with_default (node, XML_MLMC_ERROR, 0.L,
+                                                &error_code);
+  if (error_code || mlmc_error < 0.L)
+    {
+      e = 8;
+      goto fail;
+    }
+  control_variate
+    = xml_node_get_uint_with_default (node, XML_CONTROL_VARIATE, 0,
+                                      &error_code);
+  if (error_code || control_variate > 2)
+    {
+      e = 9;
+      goto fail;
+    }
+  control_trajectories = 0;
+  if (control_variate)
+    {
+      control_trajectories
+        = xml_node_get_uint_with_default (node, XML_CONTROL_TRAJECTORIES,
+                                          ntrajectories, &error_code);
+      if (error_code || control_trajectories < 2
+          || control_trajectories > ntrajectories)
+        {
+          e = 9;
+          goto fail;
+        }
+    }
+  nthreads = xml_node_get_uint_with_default (node, XML_THREADS, 1,
+                                             &error_code);
+  if (error_code)
+    {
+      e = 10;
+      goto fail;
+    }
+  if (!nthreads)
+    nthreads = g_get_num_processors ();
+  integration_threads
+    = xml_node_get_uint_with_default (node, XML_INTEGRATION_THREADS, 0,
+                                      &error_code);
+  if (error_code)
+    {
+      e = 10;
+      goto fail;
+    }
+  reference_threads
+    = xml_node_get_uint_with_default (node, XML_REFERENCE_THREADS, 1,
+                                      &error_code);
+  if (error_code || !reference_threads)
+    {
+      e = 10;
+      goto fail;
+    }
+  cost_trajectories
+    = xml_node_get_uint_with_default (node, XML_COST_TRAJECTORIES, 0,
+                                      &error_code);
+  if (error_code || cost_trajectories > LEVEL_COSTS)
+    {
+      e = 11;
+      goto fail;
+    }
 #if DEBUG_BALLISTIC
   fprintf (stderr, "convergence_read_xml: success\n");
   fprintf (stderr, "convergence_read_xml: end\n");
@@ -214,9 +404,741 @@ print_error (char *label,       ///< label.
   printf ("%s = %.19Le\n", label, distance (r1, r2));
 }
 
+/**
+ * Function to check if the RMS position error of a sequential sampling level
+ *   is known with the required relative precision.
+ *
+ * The confidence interval of the mean of the squared errors is got from the
+ * central limit theorem. The relative half width of the RMS error interval is
+ * the half of the relative half width of the mean squared error interval.
+ *
+ * \return 1 if the level is converged, 0 otherwise.
+ */
+static inline int
+sequential_converged (Statistics * s)   ///< squared position errors.
+{
+  if (!relative_precision || s->n < SEQUENTIAL_MIN)
+    return 0;
+  return 0.5L * confidence_z * sqrtl (statistics_variance (s) / s->n)
+    <= relative_precision * s->mean;
+}
+
+/**
+ * Function to get the factor of the next level.
+ *
+ * With target driven levels, the targets are error_max * 10^(-k/decade_points)
+ * and the factor is predicted from the observed order to reach the first target
+ * lower than the current error by at least half a spacing. Else, or if the
+ * order is unknown, the factor is the convergence factor.
+ *
+ * \return factor to multiply the step size and the error tolerance.
+ */
+static inline long double
+convergence_spacing (long double e,     ///< RMS error of the current level.
+                     long double order) ///< observed order.
+{
+  long double k, f;
+  if (!decade_points || order <= 0.L || e <= 0.L)
+    return convergence_factor;
+  k = fmaxl (ceill (decade_points * log10l (error_max / e) + 0.5L), 0.L);
+  f = error_max * powl (10.L, -k / decade_points);
+  f = powl (f / e, 1.L / order);
+  return fminl (fmaxl (f, 1e-3L), 0.99L);
+}
+
+/**
+ * Function to scale the step size and the error tolerances of the numerical
+ *   method.
+ */
+static inline void
+convergence_scale (Equation * eq,       ///< Equation struct.
+                   Method * m,  ///< Method struct.
+                   MultiSteps * ms,     ///< MultiSteps struct.
+                   int me,      ///< method type (1: Runge-Kutta, 2: multi-steps).
+                   long double f)       ///< scale factor.
+{
+  switch (eq->size_type)
+    {
+    case 0:
+      dt *= f;
+      break;
+    default:
+      kt *= f;
+    }
+  m->emt *= f;
+  if (me == 2)
+    RUNGE_KUTTA_METHOD (MULTI_STEPS_RUNGE_KUTTA (ms))->emt *= f;
+}
+
+/**
+ * Function to calculate a trajectory of the sample.
+ *
+ * \return final time.
+ */
+static inline long double
+trajectory_run (Sample * s,     ///< Sample struct.
+                Equation * eq,  ///< Equation struct.
+                RungeKutta * rk,        ///< RungeKutta struct.
+                MultiSteps * ms,        ///< MultiSteps struct.
+                int me,         ///< method type (1: Runge-Kutta, 2: multi-steps).
+                unsigned int i) ///< trajectory index.
+{
+  long double t;
+#if DEBUG_BALLISTIC
+  fprintf (stderr, "trajectory_run: initing equation data\n");
+#endif
+  sample_load (s, eq, i);
+#if DEBUG_BALLISTIC
+  fprintf (stderr, "trajectory_run: initing variables\n");
+#endif
+  equation_solution (eq, r0, r1, 0.);
+  equation_acceleration (eq, r0, r1, r2, 0.L);
+#if DEBUG_BALLISTIC
+  fprintf (stderr, "trajectory_run: running\n");
+#endif
+  if (me == 1)
+    t = runge_kutta_run (rk, eq);
+  else
+    t = multi_steps_run (ms, eq);
+#if DEBUG_BALLISTIC
+  fprintf (stderr, "trajectory_run: solutions\n");
+  print_solution ("Numerical solution", r0, r1);
+  printf ("Time = %.19Le\n", t);
+#endif
+  return t;
+}
+
+/**
+ * Function to calculate the horizontal range of a position vector.
+ *
+ * \return horizontal range.
+ */
+static inline long double
+trajectory_range (long double *r)       ///< position vector.
+{
+  return sqrtl (r[0] * r[0] + r[1] * r[1]);
+}
+
+/**
+ * Function to perform a multilevel Monte Carlo estimation of the mean range of
+ *   the trajectories.
+ *
+ * The level l has the step size and the error tolerances of the l-th
+ * convergence step. Every level takes MLMC_PILOT pilot trajectories, then the
+ * number of trajectories N_l of every level is got from the observed variances
+ * V_l and costs C_l (number of evaluations) to reach the required standard
+ * error E: N_l = sqrt(V_l/C_l) sum_k sqrt(V_k*C_k) / E^2. The correction
+ * samples of the level l calculate the same trajectory with the l and l-1
+ * levels. The levels take consecutive disjoint trajectories of the sample, so
+ * the total number of trajectories is limited by the sample size.
+ *
+ * The results file has a line by level with: the level, the number of
+ * trajectories, the mean and the variance of the correction and the cost per
+ * trajectory. The last line has: the estimate, its standard error, the bias
+ * estimate (absolute mean of the finest correction), the total cost and the
+ * estimated cost of a single level Monte Carlo with the same standard error.
+ *
+ * \return final time of the last trajectory.
+ */
+static inline long double
+mlmc_run (FILE * file,          ///< results file.
+          Sample * s,           ///< Sample struct.
+          Equation * eq,        ///< Equation struct.
+          Method * m,           ///< Method struct.
+          RungeKutta * rk,      ///< RungeKutta struct.
+          MultiSteps * ms,      ///< MultiSteps struct.
+          int me)               ///< method type (1: Runge-Kutta, 2: multi-steps).
+{
+  Statistics *y, *p;
+  long double *cost;
+  unsigned long int *dn;
+  long double kt0, dt0, emt0, emtr0, t, pf, pc, c, sum, estimate, variance;
+  unsigned long int ne, nopt;
+  unsigned int i, l, next, more;
+#if DEBUG_BALLISTIC
+  fprintf (stderr, "mlmc_run: start\n");
+#endif
+  y = (Statistics *) g_malloc (2 * convergence * sizeof (Statistics));
+  p = y + convergence;
+  cost = (long double *) g_malloc (convergence * sizeof (long double));
+  dn = (unsigned long int *) g_malloc (convergence * sizeof (unsigned long int));
+  for (l = 0; l < convergence; ++l)
+    {
+      statistics_init (y + l);
+      statistics_init (p + l);
+      cost[l] = 0.L;
+      dn[l] = MLMC_PILOT;
+    }
+  kt0 = kt;
+  dt0 = dt;
+  emt0 = m->emt;
+  emtr0 = 0.L;
+  if (me == 2)
+    emtr0 = RUNGE_KUTTA_METHOD (MULTI_STEPS_RUNGE_KUTTA (ms))->emt;
+  t = 0.L;
+  next = 0;
+  do
+    {
+      for (l = 0; l < convergence; ++l)
+        for (; dn[l] && next < s->n; --dn[l], ++next)
+          {
+            ne = nevaluations;
+            kt = kt0;
+            dt = dt0;
+            m->emt = emt0;
+            if (me == 2)
+              RUNGE_KUTTA_METHOD (MULTI_STEPS_RUNGE_KUTTA (ms))->emt = emtr0;
+            convergence_scale (eq, m, ms, me, powl (convergence_factor, l));
+            t = trajectory_run (s, eq, rk, ms, me, next);
+            pf = trajectory_range (r0);
+            pc = 0.L;
+            if (l)
+              {
+                convergence_scale (eq, m, ms, me, 1.L / convergence_factor);
+                trajectory_run (s, eq, rk, ms, me, next);
+                pc = trajectory_range (r0);
+              }
+            cost[l] += nevaluations - ne;
+            statistics_add (y + l, pf - pc);
+            statistics_add (p + l, pf);
+          }
+      for (l = 0, sum = 0.L; l < convergence; ++l)
+        if (y[l].n)
+          sum += sqrtl (statistics_variance (y + l) * cost[l] / y[l].n);
+      for (l = 0, more = 0; l < convergence && next < s->n; ++l)
+        {
+          c = fmaxl (cost[l] / fmaxl (y[l].n, 1.L), 1.L);
+          nopt = (unsigned long int)
+            ceill (sqrtl (statistics_variance (y + l) / c) * sum
+                   / (mlmc_error * mlmc_error));
+          if (nopt > y[l].n)
+            {
+              dn[l] = nopt - y[l].n;
+              more = 1;
+            }
+        }
+    }
+  while (more);
+  for (l = 0, estimate = variance = 0.L; l < convergence; ++l)
+    {
+      c = cost[l] / fmaxl (y[l].n, 1.L);
+      fprintf (file, "%u %lu %.19Le %.19Le %.19Le\n",
+               l, y[l].n, y[l].mean, statistics_variance (y + l), c);
+      if (y[l].n)
+        {
+          estimate += y[l].mean;
+          variance += statistics_variance (y + l) / y[l].n;
+        }
+    }
+  l = convergence - 1;
+  sum = 0.L;
+  for (i = 0; i < convergence; ++i)
+    sum += cost[i];
+  c = cost[l] / fmaxl (y[l].n, 1.L);
+  if (l)
+    c -= cost[l - 1] / fmaxl (y[l - 1].n, 1.L);
+  fprintf (file, "%.19Le %.19Le %.19Le %.19Le %.19Le\n",
+           estimate, sqrtl (variance), fabsl (y[l].mean), sum,
+           statistics_variance (p + l) * fmaxl (c, 1.L)
+           / (mlmc_error * mlmc_error));
+  g_free (dn);
+  g_free (cost);
+  g_free (y);
+#if DEBUG_BALLISTIC
+  fprintf (stderr, "mlmc_run: end\n");
+#endif
+  return t;
+}
+
+/**
+ * Function to calculate a trajectory of the sample and to add its cost to the
+ *   results of a convergence level.
+ *
+ * \return final time.
+ */
+static inline long double
+trajectory_cost (Level * lv,    ///< Level struct.
+                 Sample * s,    ///< Sample struct.
+                 Equation * eq, ///< Equation struct.
+                 RungeKutta * rk,       ///< RungeKutta struct.
+                 MultiSteps * ms,       ///< MultiSteps struct.
+                 int me,        ///< method type (1: Runge-Kutta, 2: multi-steps).
+                 unsigned int i)        ///< trajectory index.
+{
+  long double t;
+  unsigned long long int t0;
+  unsigned long int ns, ne;
+  if (!lv->max_costs)
+    return trajectory_run (s, eq, rk, ms, me, i);
+  ns = naccepted + nrejected;
+  ne = nevaluations;
+  t0 = profile_clock ();
+  t = trajectory_run (s, eq, rk, ms, me, i);
+  level_cost (lv, s->offset + i, naccepted + nrejected - ns, nevaluations - ne,
+              profile_clock () - t0);
+  return t;
+}
+
+/**
+ * Function to calculate a trajectory of a convergence level and to add its
+ *   errors to the level results.
+ *
+ * \return final time.
+ */
+static inline long double
+convergence_trajectory (Level * lv,     ///< Level struct.
+                        Sample * s,     ///< Sample struct.
+                        Equation * eq,  ///< Equation struct.
+                        RungeKutta * rk,        ///< RungeKutta struct.
+                        MultiSteps * ms,        ///< MultiSteps struct.
+                        int me,
+                        ///< method type (1: Runge-Kutta, 2: multi-steps).
+                        unsigned int i) ///< trajectory index.
+{
+  long double sr0[3], sr1[3];
+  long double t, tr;
+  t = trajectory_cost (lv, s, eq, rk, ms, me, i);
+  tr = sample_reference (s, i, sr0, sr1);
+  if (eq->land_type)
+    t = tr;
+#if DEBUG_BALLISTIC
+  print_solution ("Analytical solution", sr0, sr1);
+  printf ("Time = %.19Le\n", tr);
+  print_error ("Position error", r0, sr0);
+  print_error ("Velocity error", r1, sr1);
+#endif
+  level_add (lv, distance (r0, sr0), distance (r1, sr1));
+  return t;
+}
+
+/**
+ * Function to calculate the trajectories of a convergence level on a thread.
+ *
+ * \return NULL.
+ */
+static gpointer
+worker_run (Worker * w)         ///< Worker struct.
+{
+  long double t;
+  unsigned int i, k, begin, end;
+  nevaluations = naccepted = nrejected = 0l;
+  while (scheduler_next (w->scheduler, w->thread, &begin, &end))
+    for (i = begin; i < end; ++i)
+      {
+        k = (w->s->order) ? w->s->order[i] : i;
+        t = convergence_trajectory (w->level, w->s, w->eq, w->rk, w->ms,
+                                    w->me, k);
+        if (k == w->s->n - 1)
+          w->t = t;
+      }
+  w->level->nevaluations = nevaluations;
+  w->level->naccepted = naccepted;
+  w->level->nrejected = nrejected;
+  return NULL;
+}
+
+/**
+ * Function to calculate the trajectories of a convergence level.
+ *
+ * With several threads, every thread has its own copies of the equation and
+ * of the numerical method and the trajectories are distributed by a
+ * work-stealing scheduler. The partial results of the threads are merged
+ * exactly, so the results do not depend on the number of threads nor on the
+ * order of the trajectories. The sequential sampling is calculated with one
+ * thread in the sample order.
+ *
+ * \return final time of the last trajectory.
+ */
+static inline long double
+convergence_level (Level * lv,  ///< Level struct.
+                   Sample * s,  ///< Sample struct.
+                   Equation * eq,       ///< Equation struct.
+                   RungeKutta * rk,     ///< RungeKutta struct.
+                   MultiSteps * ms,     ///< MultiSteps struct.
+                   int me)      ///< method type (1: Runge-Kutta, 2: multi-steps).
+{
+  Scheduler scheduler[1];
+  Worker *w;
+  GThread **thread;
+  long double t, tk;
+  unsigned long long int t0;
+  unsigned int i, k;
+  t = 0.L;
+  if (relative_precision)
+    {
+      nevaluations = naccepted = nrejected = 0l;
+      for (i = 0; i < s->n; ++i)
+        {
+          t = convergence_trajectory (lv, s, eq, rk, ms, me, i);
+          if (sequential_converged (&lv->sr0q))
+            break;
+        }
+      lv->nevaluations = nevaluations;
+      lv->naccepted = naccepted;
+      lv->nrejected = nrejected;
+      return t;
+    }
+  if (nthreads == 1)
+    {
+      nevaluations = naccepted = nrejected = 0l;
+      for (i = 0; i < s->n; ++i)
+        {
+          k = (s->order) ? s->order[i] : i;
+          tk = convergence_trajectory (lv, s, eq, rk, ms, me, k);
+          if (k == s->n - 1)
+            t = tk;
+        }
+      lv->nevaluations = nevaluations;
+      lv->naccepted = naccepted;
+      lv->nrejected = nrejected;
+      return t;
+    }
+  scheduler_init (scheduler, s->n, nthreads);
+  w = (Worker *) g_malloc (nthreads * sizeof (Worker));
+  thread = (GThread **) g_malloc (nthreads * sizeof (GThread *));
+  for (i = 0; i < nthreads; ++i)
+    {
+      level_init (w[i].level, lv->kt, lv->emt, lv->f, lv->max_costs);
+      memcpy (w[i].eq, eq, sizeof (Equation));
+      if (me == 1)
+        {
+          memcpy (w[i].rk, rk, sizeof (RungeKutta));
+          runge_kutta_init_variables (w[i].rk);
+        }
+      else
+        {
+          memcpy (w[i].ms, ms, sizeof (MultiSteps));
+          multi_steps_init_variables (w[i].ms);
+        }
+      w[i].s = s;
+      w[i].scheduler = scheduler;
+      w[i].t = 0.L;
+      w[i].me = me;
+      w[i].thread = i;
+      thread[i] = g_thread_new (NULL, (GThreadFunc) worker_run, w + i);
+    }
+  for (i = 0; i < nthreads; ++i)
+    {
+      g_thread_join (thread[i]);
+      t0 = profile_clock ();
+      level_merge (lv, w[i].level);
+      profile_add (PROFILE_REDUCTION, profile_clock () - t0);
+      if (w[i].t != 0.L)
+        t = w[i].t;
+      if (me == 1)
+        runge_kutta_delete (w[i].rk);
+      else
+        multi_steps_delete (w[i].ms);
+    }
+  g_free (thread);
+  g_free (w);
+  scheduler_delete (scheduler);
+  return t;
+}
+
+/**
+ * Function to pass a sampled trajectory to the integration and to the
+ *   reference solution stages of the pipeline.
+ */
+static void
+pipeline_ready (Pipeline * p,   ///< Pipeline struct.
+                unsigned int i) ///< trajectory index.
+{
+  queue_push (p->integration, i);
+  queue_push (p->reference, i);
+}
+
+/**
+ * Function to join the numerical and the reference solutions of a trajectory.
+ *
+ * Every stage marks the trajectory as done when it finishes, so the stage
+ * finishing in second place adds the errors to its partial level results.
+ */
+static inline void
+pipeline_join (Pipeline * p,    ///< Pipeline struct.
+               Level * lv,      ///< partial Level struct of the thread.
+               unsigned int i)  ///< trajectory index.
+{
+  long double sr0[3], sr1[3];
+  long double *r;
+  if (__atomic_add_fetch (p->done + i, 1, __ATOMIC_ACQ_REL) != 2)
+    return;
+  sample_reference (p->s, i, sr0, sr1);
+  r = p->result + 6 * (size_t) i;
+  level_add (lv, distance (r, sr0), distance (r + 3, sr1));
+}
+
+/**
+ * Function to calculate the numerical solutions of the trajectories on an
+ *   integration thread of the pipeline.
+ *
+ * \return NULL.
+ */
+static gpointer
+pipeline_integrate (Worker * w) ///< Worker struct.
+{
+  Pipeline *p = w->pipeline;
+  long double *r;
+  long double t;
+  unsigned int i;
+  nevaluations = naccepted = nrejected = 0l;
+  while ((i = queue_pop (p->integration)) != QUEUE_END)
+    {
+      t = trajectory_cost (w->level, w->s, w->eq, w->rk, w->ms, w->me, i);
+      if (i == w->s->n - 1)
+        w->t = t;
+      r = p->result + 6 * (size_t) i;
+      memcpy (r, r0, 3 * sizeof (long double));
+      memcpy (r + 3, r1, 3 * sizeof (long double));
+      pipeline_join (p, w->level, i);
+    }
+  w->level->nevaluations = nevaluations;
+  w->level->naccepted = naccepted;
+  w->level->nrejected = nrejected;
+  return NULL;
+}
+
+/**
+ * Function to calculate the reference solutions of the trajectories on a
+ *   reference solution thread of the pipeline.
+ *
+ * With the batch option, the trajectories are collected on lists of a batch
+ * size and solved by the vectorizable batch functions.
+ *
+ * \return NULL.
+ */
+static gpointer
+pipeline_reference (Worker * w) ///< Worker struct.
+{
+  unsigned int list[SAMPLE_BATCH];
+  Pipeline *p = w->pipeline;
+  unsigned int i, j, n;
+  if (w->s->batch)
+    do
+      {
+        for (n = 0; n < SAMPLE_BATCH
+             && (i = queue_pop (p->reference)) != QUEUE_END; ++n)
+          list[n] = i;
+        sample_solve_list (w->s, w->eq, list, n);
+        for (j = 0; j < n; ++j)
+          pipeline_join (p, w->level, list[j]);
+      }
+    while (n == SAMPLE_BATCH);
+  else
+    while ((i = queue_pop (p->reference)) != QUEUE_END)
+      {
+        sample_load (w->s, w->eq, i);
+        sample_solve (w->s, w->eq, i);
+        pipeline_join (p, w->level, i);
+      }
+  return NULL;
+}
+
+/**
+ * Function to generate the sample and to calculate the first convergence
+ *   level as a pipeline.
+ *
+ * The main thread generates the initial conditions of the trajectories (the
+ * sampling stage is sequential because the random numbers streams are) and
+ * passes their indices by two lock-free bounded queues to the integration
+ * threads and to the reference solution threads. The solutions are joined by
+ * the trajectory index, so the stages only wait when a queue is full or empty.
+ * The partial results are merged exactly, so the results are the same as
+ * generating the whole sample before the first level.
+ *
+ * \return final time of the last trajectory.
+ */
+static inline long double
+convergence_pipeline (Level * lv,       ///< Level struct.
+                      Sample * s,       ///< Sample struct.
+                      Equation * eq,    ///< Equation struct.
+                      RungeKutta * rk,  ///< RungeKutta struct.
+                      MultiSteps * ms,  ///< MultiSteps struct.
+                      int me,
+                      ///< method type (1: Runge-Kutta, 2: multi-steps).
+                      gsl_rng * rng)    ///< gsl_rng struct.
+{
+  Pipeline *p;
+  Worker *w;
+  GThread **thread;
+  long double t;
+  unsigned long long int t0;
+  unsigned int i, n;
+#if DEBUG_BALLISTIC
+  fprintf (stderr, "convergence_pipeline: start\n");
+#endif
+  p = (Pipeline *) g_malloc (sizeof (Pipeline));
+  queue_init (p->integration);
+  queue_init (p->reference);
+  p->result = (long double *)
+    g_malloc (6 * (size_t) ntrajectories * sizeof (long double));
+  p->done = (unsigned char *) g_malloc0 (ntrajectories);
+  p->s = s;
+  s->ready = (void (*)(void *, unsigned int)) pipeline_ready;
+  s->data_ready = p;
+  n = integration_threads + reference_threads;
+  w = (Worker *) g_malloc (n * sizeof (Worker));
+  thread = (GThread **) g_malloc (n * sizeof (GThread *));
+  for (i = 0; i < n; ++i)
+    {
+      level_init (w[i].level, lv->kt, lv->emt, lv->f, lv->max_costs);
+      memcpy (w[i].eq, eq, sizeof (Equation));
+      w[i].eq->r[0] = w[i].eq->r[1] = 0.L;
+      w[i].s = s;
+      w[i].scheduler = NULL;
+      w[i].pipeline = p;
+      w[i].t = 0.L;
+      w[i].me = me;
+      w[i].thread = i;
+      if (i >= integration_threads)
+        {
+          thread[i]
+            = g_thread_new (NULL, (GThreadFunc) pipeline_reference, w + i);
+          continue;
+        }
+      if (me == 1)
+        {
+          memcpy (w[i].rk, rk, sizeof (RungeKutta));
+          runge_kutta_init_variables (w[i].rk);
+        }
+      else
+        {
+          memcpy (w[i].ms, ms, sizeof (MultiSteps));
+          multi_steps_init_variables (w[i].ms);
+        }
+      thread[i] = g_thread_new (NULL, (GThreadFunc) pipeline_integrate, w + i);
+    }
+  sample_init (s, eq, rng, ntrajectories);
+  for (i = 0; i < integration_threads; ++i)
+    queue_push (p->integration, QUEUE_END);
+  for (i = 0; i < reference_threads; ++i)
+    queue_push (p->reference, QUEUE_END);
+  t = 0.L;
+  for (i = 0; i < n; ++i)
+    {
+      g_thread_join (thread[i]);
+      t0 = profile_clock ();
+      level_merge (lv, w[i].level);
+      profile_add (PROFILE_REDUCTION, profile_clock () - t0);
+      if (i >= integration_threads)
+        continue;
+      if (w[i].t != 0.L)
+        t = w[i].t;
+      if (me == 1)
+        runge_kutta_delete (w[i].rk);
+      else
+        multi_steps_delete (w[i].ms);
+    }
+  if (eq->land_type)
+    t = s->t[s->n - 1];
+  s->ready = NULL;
+  s->data_ready = NULL;
+  if (s->sort)
+    sample_sort (s, eq);
+  g_free (thread);
+  g_free (w);
+  g_free (p->done);
+  g_free (p->result);
+  g_free (p);
+#if DEBUG_BALLISTIC
+  fprintf (stderr, "convergence_pipeline: end\n");
+#endif
+  return t;
+}
+
+/**
+ * Function to estimate the mean and the dispersion of the range of the
+ *   trajectories with an analytical control variate.
+ *
+ * The first control_trajectories trajectories are calculated with the
+ * numerical method (Y) and with the analytical solution of the surrogate model
+ * (X) from the same initial conditions. The mean of X and X^2 are calculated
+ * with all the trajectories of the sample. The variance reduced estimates are:
+ * E[Y] = mean(Y) - b (mean(X) - E[X]) with b = cov(X,Y) / var(X), and the same
+ * with Y^2 and X^2 to get the second moment. As mean(X) is estimated with the
+ * N trajectories of the sample, the variance of the estimate with n numerical
+ * trajectories is: var(Y) (1 - rho^2) / n + rho^2 var(Y) / N, which is
+ * var(Y) / N without variance reduction when n = N.
+ *
+ * The results file has a line with: the number of numerically calculated
+ * trajectories, the mean range and its standard error, the variance reduced
+ * mean range and its standard error, the range standard deviation, the
+ * variance reduced range standard deviation, the correlation coefficient and
+ * the standard error of the variance reduced second moment of the range.
+ *
+ * \return final time of the last trajectory.
+ */
+static inline long double
+control_run (FILE * file,       ///< results file.
+             Sample * s,        ///< Sample struct.
+             Equation * eq,     ///< Equation struct.
+             RungeKutta * rk,   ///< RungeKutta struct.
+             MultiSteps * ms,   ///< MultiSteps struct.
+             int me)            ///< method type (1: Runge-Kutta, 2: multi-steps).
+{
+  Covariance c1[1], c2[1];
+  Statistics sx1[1], sx2[1];
+  long double sr0[3], sr1[3];
+  long double t, x, y, v, v2, rho, rho2, m1, m2;
+  unsigned int i;
+#if DEBUG_BALLISTIC
+  fprintf (stderr, "control_run: start\n");
+#endif
+  covariance_init (c1);
+  covariance_init (c2);
+  statistics_init (sx1);
+  statistics_init (sx2);
+  t = 0.L;
+  for (i = 0; i < s->n; ++i)
+    {
+      sample_load (s, eq, i);
+      equation_surrogate (eq, control_variate, sr0, sr1);
+      x = trajectory_range (sr0);
+      statistics_add (sx1, x);
+      statistics_add (sx2, x * x);
+      if (i < control_trajectories)
+        {
+          t = trajectory_run (s, eq, rk, ms, me, i);
+          y = trajectory_range (r0);
+          covariance_add (c1, x, y);
+          covariance_add (c2, x * x, y * y);
+        }
+    }
+  v = c1->syy / (c1->n - 1);
+  v2 = c2->syy / (c2->n - 1);
+  rho = covariance_correlation (c1);
+  rho2 = covariance_correlation (c2);
+  m1 = c1->my;
+  if (c1->sxx > 0.L)
+    m1 -= c1->sxy / c1->sxx * (c1->mx - sx1->mean);
+  m2 = c2->my;
+  if (c2->sxx > 0.L)
+    m2 -= c2->sxy / c2->sxx * (c2->mx - sx2->mean);
+  fprintf (file, "%lu %.19Le %.19Le %.19Le %.19Le %.19Le %.19Le %.19Le"
+           " %.19Le\n",
+           c1->n, c1->my, sqrtl (v / c1->n), m1,
+           sqrtl (v * (1.L - rho * rho) / c1->n + rho * rho * v / s->n),
+           sqrtl (v), sqrtl (fmaxl (m2 - m1 * m1, 0.L)), rho,
+           sqrtl (v2 * (1.L - rho2 * rho2) / c2->n
+                  + rho2 * rho2 * v2 / s->n));
+#if DEBUG_BALLISTIC
+  fprintf (stderr, "control_run: end\n");
+#endif
+  return t;
+}
+
 /**
  * Function to perform a convergence analysis of a method.
  *
+ * The analysis stops after the convergence steps, when the RMS position error
+ * reaches the target error or when the observed order falls under the minimum
+ * order (roundoff errors floor). With a multilevel Monte Carlo error, the
+ * convergence steps are the levels of a multilevel Monte Carlo estimation.
+ * With a control variate, only the first convergence step is calculated to
+ * get variance reduced estimates of the range. With integration threads and
+ * a fixed sampling, the sample and the first convergence step are calculated
+ * as a pipeline.
+ *
  * \return 0 on success, error code on error.
  */
 static inline int
@@ -228,27 +1150,45 @@ convergence_run (xmlNode * node,   ///< XML node.
 		"Bad convergence data",
 		"No equation XML node",
 		"Unknown numerical method",
-		"Bad numerical method data"
+		"Bad numerical method data",
+		"Bad control variate model",
+		"Bad shard options",
+		"Unable to write the shard file",
+		"Unable to write the profile file",
+		"Unable to open the results file",
+		"Unable to open the costs file"
 	};
   MultiSteps ms[1];
   RungeKutta rk[1];
   Equation eq[1];
+  Sample s[1];
+  Level lv[1];
+  ShardHeader header[1];
   Method *m;
   gsl_rng *rng;
-  FILE *file;
-  long double sr0[3], sr1[3];
-  long double t, l0r0, l2r0, l0r1, l2r1, e;
+  FILE *file, *costs;
+  char *name;
+  long double t, e, e0, f, order;
+  unsigned long long int t0, c0, tr;
 	int er, me;
-  unsigned int i, j;
+  unsigned int j, nlevels, pipeline;
 #if DEBUG_BALLISTIC
   fprintf (stderr, "convergence_run: start\n");
 #endif
 	er = 0;
-  if (!convergence_read_xml (node))
+  if (!convergence_read_xml (node) || !sample_read_xml (s, node))
 	  {
       er = 1;
 			goto fail;
 		}
+
+  // the shards have to be fixed samplings of geometric convergence levels
+  if (shard && (relative_precision || decade_points || mlmc_error
+                || control_variate))
+    {
+      er = 6;
+      goto fail;
+    }
 #if DEBUG_BALLISTIC
   fprintf (stderr, "convergence_run: initing equation\n");
 #endif
@@ -266,6 +1206,11 @@ convergence_run (xmlNode * node,   ///< XML node.
 #if DEBUG_BALLISTIC
   fprintf (stderr, "convergence_run: initing method\n");
 #endif
+  if (control_variate && !eq->type)
+    {
+      er = 5;
+      goto fail;
+    }
 	node = node->next;
 	me = method_open_xml (ms, rk, node);
 	switch (me)
@@ -281,79 +1226,150 @@ convergence_run (xmlNode * node,   ///< XML node.
 			goto fail;
 		}
   rng = gsl_rng_alloc (gsl_rng_taus2);
-  file = fopen (output, "w");
-  for (j = 0; j < convergence; ++j)
-    {
-      gsl_rng_set (rng, 0l);
-      nevaluations = 0l;
-      l0r0 = l2r0 = l0r1 = l2r1 = 0.L;
-      for (i = 0; i < ntrajectories; ++i)
-        {
+  gsl_rng_set (rng, 0l);
 #if DEBUG_BALLISTIC
-          fprintf (stderr, "convergence_run: initing equation data\n");
+  fprintf (stderr, "convergence_run: initing sample\n");
 #endif
-          equation_init (eq, rng);
-#if DEBUG_BALLISTIC
-          fprintf (stderr, "convergence_run: initing variables\n");
-#endif
-          equation_solution (eq, r0, r1, 0.);
-          equation_acceleration (eq, r0, r1, r2, 0.L);
-#if DEBUG_BALLISTIC
-          fprintf (stderr, "convergence_run: running\n");
-#endif
-          if (me == 1)
-            t = runge_kutta_run (rk, eq);
-          else
-            t = multi_steps_run (ms, eq);
-#if DEBUG_BALLISTIC
-          fprintf (stderr, "convergence_run: solutions\n");
-          print_solution ("Numerical solution", r0, r1);
-          printf ("Time = %.19Le\n", t);
-#endif
-          switch (eq->land_type)
+  pipeline = integration_threads && !relative_precision && !mlmc_error
+    && !control_variate;
+  if (!pipeline)
+    sample_init (s, eq, rng, ntrajectories);
+  costs = NULL;
+  t = 0.L;
+  if (shard)
+    {
+      file = fopen (output, "wb");
+      if (!file)
+        {
+          er = 7;
+          goto delete;
+        }
+      memset (header, 0, sizeof (ShardHeader));
+      header->min_order = min_order;
+      header->target_error = target_error;
+      header->nlevels = convergence;
+      header->type = s->type;
+      header->seed = s->seed;
+      header->scramble = s->scramble;
+      header->offset = s->offset;
+      header->ntrajectories = ntrajectories;
+      if (!shard_write_header (file, header))
+        {
+          er = 7;
+          goto close;
+        }
+    }
+  else
+    {
+      file = fopen (output, "w");
+      if (!file)
+        {
+          er = 9;
+          goto delete;
+        }
+      if (cost_trajectories && !mlmc_error && !control_variate)
+        {
+          name = g_strconcat (output, ".cost", NULL);
+          costs = fopen (name, "w");
+          g_free (name);
+          if (!costs)
             {
-            case 0:
-              equation_solution (eq, sr0, sr1, eq->tf);
-              break;
-            default:
-              t = equation_solve (eq, sr0, sr1);
+              er = 10;
+              goto close;
             }
-#if DEBUG_BALLISTIC
-          print_solution ("Analytical solution", sr0, sr1);
-          printf ("Time = %.19Le\n", t);
-          print_error ("Position error", r0, sr0);
-          print_error ("Velocity error", r1, sr1);
-#endif
-          e = distance (r0, sr0);
-          l0r0 = fmaxl (l0r0, e);
-          l2r0 += e * e;
-          e = distance (r1, sr1);
-          l0r1 = fmaxl (l0r1, e);
-          l2r1 += e * e;
-
         }
+    }
+  if (mlmc_error || control_variate)
+    {
+      nevaluations = naccepted = nrejected = 0l;
+      profile_perf_start ();
+      t0 = profile_clock ();
+      if (mlmc_error)
+        {
+          nlevels = convergence;
+          t = mlmc_run (file, s, eq, m, rk, ms, me);
+        }
+      else
+        {
+          nlevels = 1;
+          t = control_run (file, s, eq, rk, ms, me);
+        }
+      profile_add (PROFILE_INTEGRATION, profile_clock () - t0);
+      profile_perf_stop (nevaluations, s->n);
+      profile->nevaluations = nevaluations;
+      profile->naccepted = naccepted;
+      profile->nrejected = nrejected;
+      goto close;
+    }
+  e0 = 0.L;
+  f = convergence_factor;
+  for (j = nlevels = 0; j < convergence; ++j)
+    {
+      level_init (lv, kt, m->emt, f, cost_trajectories);
+      profile_perf_start ();
+      c0 = profile_cpu_clock ();
+      t0 = profile_clock ();
+      tr = profile->time[PROFILE_REDUCTION];
+      if (!j && pipeline)
+        t = convergence_pipeline (lv, s, eq, rk, ms, me, rng);
+      else
+        t = convergence_level (lv, s, eq, rk, ms, me);
+      t0 = profile_clock () - t0;
+      lv->time = 1e-9L * t0;
+      lv->cpu_time = 1e-9L * (profile_cpu_clock () - c0);
+      profile_add (PROFILE_INTEGRATION,
+                   t0 - (profile->time[PROFILE_REDUCTION] - tr));
+      profile_perf_stop (lv->nevaluations, lv->sr0s.n);
+      profile->nevaluations += lv->nevaluations;
+      profile->naccepted += lv->naccepted;
+      profile->nrejected += lv->nrejected;
+      ++nlevels;
 #if DEBUG_BALLISTIC
       fprintf (stderr, "convergence_run: saving results\n");
 #endif
-      l2r0 = sqrtl (l2r0 / ntrajectories);
-      l2r1 = sqrtl (l2r1 / ntrajectories);
-      fprintf (file, "%lu %.19Le %.19Le %.19Le %.19Le %.19Le %.19Le\n",
-               nevaluations, l0r0, l2r0, l0r1, l2r1, kt, m->emt);
-      switch (eq->size_type)
+      t0 = profile_clock ();
+      if (shard)
         {
-        case 0:
-          dt *= convergence_factor;
-          break;
-        default:
-          kt *= convergence_factor;
+          // the stop criteria are applied on merging the shards
+          if (fwrite (lv, sizeof (Level), 1, file) != 1)
+            {
+              er = 7;
+              goto close;
+            }
+          profile_add (PROFILE_OUTPUT, profile_clock () - t0);
+          e = statistics_rms (&lv->sr0s);
+          order = 0.L;
+        }
+      else
+        {
+          e = level_print (lv, file, e0, &order);
+          if (costs)
+            level_print_costs (lv, costs, j);
+          profile_add (PROFILE_OUTPUT, profile_clock () - t0);
+          if (e <= target_error || (order && order < min_order))
+            break;
         }
-      m->emt *= convergence_factor;
-      if (me == 2)
-        RUNGE_KUTTA_METHOD (MULTI_STEPS_RUNGE_KUTTA (ms))->emt
-          *= convergence_factor;
+      e0 = e;
+      f = convergence_spacing (e, order);
+      convergence_scale (eq, m, ms, me, f);
     }
+close:
+  t0 = profile_clock ();
   fclose (file);
+  if (costs)
+    fclose (costs);
+  profile_add (PROFILE_OUTPUT, profile_clock () - t0);
   printf ("Time = %.19Le\n", t);
+  if (!er)
+    {
+      name = g_strconcat (output, ".json", NULL);
+      if (!profile_write (name, (me == 1) ? (const char *) XML_RUNGE_KUTTA
+                          : (const char *) XML_MULTI_STEPS, m->order, s->n,
+                          nlevels))
+        er = 8;
+      g_free (name);
+    }
+delete:
 #if DEBUG_BALLISTIC
   fprintf (stderr, "convergence_run: deleting method\n");
 #endif
@@ -361,6 +1377,7 @@ convergence_run (xmlNode * node,   ///< XML node.
     runge_kutta_delete (rk);
   else
     multi_steps_delete (ms);
+  sample_delete (s);
   gsl_rng_free (rng);
 fail:
 	if (er)
@@ -374,6 +1391,147 @@ fail:
   return 0;
 }
 
+/**
+ * Function to read and merge the levels of a shard file.
+ *
+ * \return 0 on success, error code on error.
+ */
+static inline int
+merge_shard (FILE * file,       ///< shard file.
+             Level ** lv,       ///< pointer to the array of merged levels.
+             ShardHeader * h,
+             ///< array of the headers of the shard files read before.
+             unsigned int nshards)
+  ///< number of shard files read before.
+{
+  Level l2[1];
+  ShardHeader *h2;
+  unsigned int i, nl;
+  h2 = h + nshards;
+  if (!shard_read_header (file, h2))
+    return 2;
+  nl = h2->nlevels;
+  if (!nshards)
+    {
+      min_order = h2->min_order;
+      target_error = h2->target_error;
+      *lv = (Level *) g_malloc (nl * sizeof (Level));
+      return (fread (*lv, sizeof (Level), nl, file) == nl) ? 0 : 2;
+    }
+  if (nl != h->nlevels || h2->min_order != min_order
+      || h2->target_error != target_error || h2->type != h->type
+      || h2->seed != h->seed || h2->scramble != h->scramble)
+    return 3;
+  for (i = 0; i < nshards; ++i)
+    if (h2->offset < h[i].offset + h[i].ntrajectories
+        && h[i].offset < h2->offset + h2->ntrajectories)
+      return 6;
+  for (i = 0; i < nl; ++i)
+    {
+      if (fread (l2, sizeof (Level), 1, file) != 1)
+        return 2;
+      if (l2->kt != (*lv)[i].kt || l2->emt != (*lv)[i].emt
+          || l2->f != (*lv)[i].f)
+        return 3;
+      level_merge (*lv + i, l2);
+    }
+  return 0;
+}
+
+/**
+ * Function to merge the partial results of shard files on a results file.
+ *
+ * The shards are the results of the same convergence analysis on disjoint
+ * trajectories (different sample offsets). The shards with different samplings
+ * or seeds or with overlapping trajectories are rejected. The results file has
+ * the same format and stop criteria as a convergence analysis of all the
+ * trajectories.
+ *
+ * \return 0 on success, error code on error.
+ */
+static inline int
+merge_run (char *output,        ///< results file name.
+           char **shards,       ///< array of shard file names.
+           unsigned int nshards)        ///< number of shard files.
+{
+  const char *message[] = {
+    NULL,
+    "Unable to open a shard file",
+    "Bad shard file",
+    "Incompatible shard files",
+    "Unable to open the results file",
+    "Unable to open the costs file",
+    "Overlapping shard files"
+  };
+  ShardHeader *h;
+  Level *lv;
+  FILE *file, *costs;
+  char *name;
+  long double e, e0, order;
+  unsigned int i, n;
+  int er;
+#if DEBUG_BALLISTIC
+  fprintf (stderr, "merge_run: start\n");
+#endif
+  er = 0;
+  lv = NULL;
+  h = (ShardHeader *) g_malloc (nshards * sizeof (ShardHeader));
+  for (i = 0; i < nshards; ++i)
+    {
+      file = fopen (shards[i], "rb");
+      if (!file)
+        {
+          er = 1;
+          goto fail;
+        }
+      er = merge_shard (file, &lv, h, i);
+      fclose (file);
+      if (er)
+        goto fail;
+    }
+  n = h->nlevels;
+  file = fopen (output, "w");
+  if (!file)
+    {
+      er = 4;
+      goto fail;
+    }
+  costs = NULL;
+  if (n && lv->max_costs)
+    {
+      name = g_strconcat (output, ".cost", NULL);
+      costs = fopen (name, "w");
+      g_free (name);
+      if (!costs)
+        {
+          er = 5;
+          fclose (file);
+          goto fail;
+        }
+    }
+  for (i = 0, e0 = 0.L; i < n; ++i)
+    {
+      e = level_print (lv + i, file, e0, &order);
+      if (costs)
+        level_print_costs (lv + i, costs, i);
+      if (e <= target_error || (order && order < min_order))
+        break;
+      e0 = e;
+    }
+  fclose (file);
+  if (costs)
+    fclose (costs);
+fail:
+  g_free (h);
+  g_free (lv);
+  if (er)
+    error_add (message[er]);
+#if DEBUG_BALLISTIC
+  fprintf (stderr, "merge_run: end\n");
+#endif
+  return er;
+}
+
 /**
  * Function to calculate a ballistic trajectory.
  *
@@ -410,6 +1568,7 @@ ballistic_run (xmlNode * node)    ///< XML node.
       e = 4;
       goto end;
     }
+  equation_invariants (eq);
   node = node->next;
   if (!node)
     {
@@ -507,27 +1666,53 @@ main (int argn,                 ///< number of arguments.
 {
 	const char *message[] = {
 		NULL,
-    "The syntax is:\n./ballistic input_file output_file\n",
+    "The syntax is:\n./ballistic [--perf-counters] input_file output_file\n"
+    "./ballistic [--perf-counters] shard input_file shard_file\n"
+    "./ballistic merge output_file shard_file_1 [shard_file_2 ...]\n",
 		"Unable to open the input file",
 		"Bad XML root element",
 	  "Bad ballistic run",
 	  "Bad convergence run",
-		"Unknown model"
+		"Unknown model",
+		"Bad merge"
 	};
   xmlDoc *doc;
 	xmlNode *node;
+  unsigned long long int t0;
   int e;
 #if DEBUG_BALLISTIC
   fprintf (stderr, "main: start\n");
 #endif
 	e = 0;
+  profile_init ();
+  if (argn >= 2 && !strcmp (argc[1], "--perf-counters"))
+    {
+      if (!profile_perf_open ())
+        fprintf (stderr, "Unable to open the hardware performance counters\n");
+      --argn;
+      ++argc;
+    }
+  if (argn >= 4 && !strcmp (argc[1], "merge"))
+    {
+      if (merge_run (argc[2], argc + 3, argn - 3))
+        e = 7;
+      goto end;
+    }
+  if (argn == 4 && !strcmp (argc[1], "shard"))
+    {
+      shard = 1;
+      --argn;
+      ++argc;
+    }
 	if (argn != 3)
 	  {
 			e = 1;
 			goto end;
 		}
   xmlKeepBlanksDefault (0);
+  t0 = profile_clock ();
   doc = xmlParseFile (argc[1]);
+  profile_add (PROFILE_PARSE, profile_clock () - t0);
   if (!doc)
 	  {
 			e = 2;
@@ -561,6 +1746,7 @@ main (int argn,                 ///< number of arguments.
 	  e = 6;
   xmlFreeDoc (doc);
 end:
+  profile_delete ();
   if (e)
     {
 			error_add (message[e]);
@@ -0,0 +1,720 @@
+/*
+Ballistic: a software to benchmark ballistic models.
+
+AUTHORS: Javier Burguete Tolosa.
+
+Copyright 2018, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+/**
+ * \file batch-math.c
+ * \brief Source file to define the vectorizable mathematical functions on
+ *   arrays.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2018.
+ *
+ * The functions are calculated in double precision by argument reduction and
+ * polynomial kernels without branches nor calls to the mathematical library,
+ * so the loops can be vectorized. The Cody-Waite reduction constants are the
+ * fdlibm ones. The selections are comparisons, so the file has to be compiled
+ * with -fno-trapping-math to convert them in vector masks.
+ *
+ * The special values (zeros, subnormals, infinities and NaNs) and the
+ * overflows are also selected without branches, so they give the C99 Annex F
+ * results. Only the trigonometric functions have a restricted domain:
+ * \f$|x|<2^{19}\,\pi/2\f$.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "config.h"
+#include "batch-math.h"
+
+#define BATCH_MATH_ROUND 0x1.8p52
+///< constant to round a number to the nearest integer.
+#define BATCH_MATH_LN2_HI 6.93147180369123816490e-01
+///< 1st part of the logarithm of 2.
+#define BATCH_MATH_LN2_LO 1.90821492927058770002e-10
+///< 2nd part of the logarithm of 2.
+#define BATCH_MATH_PIO2_1 1.57079632673412561417e+00
+///< 1st part of pi/2.
+#define BATCH_MATH_PIO2_2 6.07710050630396597660e-11
+///< 2nd part of pi/2.
+#define BATCH_MATH_PIO2_3 2.02226624871116645580e-21
+///< 3rd part of pi/2.
+
+/**
+ * Function to round a number to the nearest integer.
+ *
+ * \return rounded number.
+ */
+static inline double
+batch_math_rint (double x)      ///< number (|x|<2^51).
+{
+  return (x + BATCH_MATH_ROUND) - BATCH_MATH_ROUND;
+}
+
+/**
+ * Function to calculate an integer power of 2.
+ *
+ * The exponent is got from the mantissa bits of \f$2^{52}+1023+k\f$, so there
+ * are not conversions between floating point and integer numbers.
+ *
+ * \return power of 2.
+ */
+static inline double
+batch_math_pow2 (double k)      ///< integer exponent (-1022<=k<=1023).
+{
+  double x;
+  uint64_t i;
+  x = k + (0x1p52 + 1023.);
+  memcpy (&i, &x, sizeof (double));
+  i <<= 52;
+  memcpy (&x, &i, sizeof (double));
+  return x;
+}
+
+/**
+ * Function to get the two lower bits of an integer number.
+ *
+ * \return two lower bits.
+ */
+static inline uint64_t
+batch_math_quadrant (double k)  ///< integer number (|k|<2^51).
+{
+  double x;
+  uint64_t i;
+  x = k + BATCH_MATH_ROUND;
+  memcpy (&i, &x, sizeof (double));
+  return i & 3;
+}
+
+/**
+ * Function to add two numbers getting the rounding error when the 1st number
+ *   is not smaller than the 2nd one in absolute value (Dekker).
+ *
+ * \return rounded sum.
+ */
+static inline double
+batch_math_fast_two_sum (double a,      ///< 1st number.
+                         double b,      ///< 2nd number.
+                         double *e)     ///< pointer to the rounding error.
+{
+  double s;
+  s = a + b;
+  *e = b - (s - a);
+  return s;
+}
+
+/**
+ * Function to add two numbers getting the rounding error (Knuth).
+ *
+ * \return rounded sum.
+ */
+static inline double
+batch_math_two_sum (double a,   ///< 1st number.
+                    double b,   ///< 2nd number.
+                    double *e)  ///< pointer to the rounding error.
+{
+  double s, c;
+  s = a + b;
+  c = s - a;
+  *e = (a - (s - c)) + (b - c);
+  return s;
+}
+
+/**
+ * Function to multiply two numbers getting the rounding error without fused
+ *   multiply-add instructions (Veltkamp and Dekker).
+ *
+ * \return rounded product.
+ */
+static inline double
+batch_math_two_prod (double a,  ///< 1st number.
+                     double b,  ///< 2nd number.
+                     double *e) ///< pointer to the rounding error.
+{
+  double p, c, ah, al, bh, bl;
+  p = a * b;
+  c = 134217729. * a;
+  ah = c - (c - a);
+  al = a - ah;
+  c = 134217729. * b;
+  bh = c - (c - b);
+  bl = b - bh;
+  *e = ((ah * bh - p) + ah * bl + al * bh) + al * bl;
+  return p;
+}
+
+/**
+ * Function to add two double-double numbers.
+ *
+ * \return high part of the sum.
+ */
+static inline double
+batch_math_dd_add (double ah,   ///< high part of the 1st number.
+                   double al,   ///< low part of the 1st number.
+                   double bh,   ///< high part of the 2nd number.
+                   double bl,   ///< low part of the 2nd number.
+                   double *l)   ///< pointer to the low part of the sum.
+{
+  double s, e;
+  s = batch_math_two_sum (ah, bh, &e);
+  return batch_math_fast_two_sum (s, e + (al + bl), l);
+}
+
+/**
+ * Function to divide two double-double numbers.
+ *
+ * \return high part of the quotient.
+ */
+static inline double
+batch_math_dd_div (double ah,   ///< high part of the dividend.
+                   double al,   ///< low part of the dividend.
+                   double bh,   ///< high part of the divisor.
+                   double bl,   ///< low part of the divisor.
+                   double *l)   ///< pointer to the low part of the quotient.
+{
+  double q, p, e;
+  q = ah / bh;
+  p = batch_math_two_prod (q, bh, &e);
+  return batch_math_fast_two_sum (q, (((ah - p) - e) + (al - q * bl)) / bh,
+                                  l);
+}
+
+/**
+ * Function to calculate \f$\exp(r)-1-r\f$ on the reduced interval
+ *   \f$|r|\leq\ln(2)/2\f$ as a double-double number by its Taylor polynomial.
+ *
+ * \return high part of \f$\exp(r)-1-r\f$ (exactly \f$r^2/2\f$ rounded).
+ */
+static inline double
+batch_math_expm1_reduced (double r,     ///< reduced argument.
+                          double *l)    ///< pointer to the low part.
+{
+  double z, e;
+  z = batch_math_two_prod (r, r, &e);
+  *l = 0.5 * e + r * z * (1. / 6. + r * (1. / 24. + r * (1. / 120. + r
+                          * (1. / 720. + r * (1. / 5040. + r * (1. / 40320.
+                          + r * (1. / 362880. + r * (1. / 3628800. + r
+                          * (1. / 39916800. + r * (1. / 479001600. + r
+                          * (1. / 6227020800.)))))))))));
+  return 0.5 * z;
+}
+
+/**
+ * Function to reduce the argument of the exponential function:
+ *   \f$x=k\,\ln(2)+r+e\f$ with \f$|r|\leq\ln(2)/2\f$ and the rounding error
+ *   \f$e\f$ of \f$r\f$.
+ *
+ * \return reduced argument.
+ */
+static inline double
+batch_math_exp_reduce (double x,        ///< argument.
+                       double *k,       ///< pointer to the power of 2.
+                       double *e)       ///< pointer to the rounding error.
+{
+  double dk, h, l, r;
+  dk = *k = batch_math_rint (x * M_LOG2E);
+  h = x - dk * BATCH_MATH_LN2_HI;
+  l = dk * BATCH_MATH_LN2_LO;
+  r = h - l;
+  *e = (h - r) - l;
+  return r;
+}
+
+/**
+ * Function to calculate the exponential function as a double-double number
+ *   with the argument reduced to \f$x=k\,\ln(2)+r\f$.
+ *
+ * \return high part of \f$\exp(r)\f$.
+ */
+static inline double
+batch_math_exp_dd (double x,    ///< argument (-746<=x<=711).
+                   double *k,   ///< pointer to the power of 2.
+                   double *l)   ///< pointer to the low part of exp(r).
+{
+  double r, e, h, hl, s, c, s2, c2;
+  r = batch_math_exp_reduce (x, k, &e);
+  h = batch_math_expm1_reduced (r, &hl);
+  s = batch_math_fast_two_sum (1., r, &c);
+  s2 = batch_math_fast_two_sum (s, h, &c2);
+  return batch_math_fast_two_sum (s2, (c + c2) + (hl + e), l);
+}
+
+/**
+ * Function to calculate \f$2^j\,(\exp(x)-1)\f$ as a double-double number
+ *   without cancellation near 0.
+ *
+ * The arguments are clamped to \f$[-40,711]\f$. Near the overflow the
+ * calculation is done with a power of 2 lower than 1023 and the result is
+ * scaled at the end, so it overflows only if the scaled result does it.
+ *
+ * \return high part of \f$2^j\,(\exp(x)-1)\f$.
+ */
+static inline double
+batch_math_expm1_dd (double x,  ///< argument.
+                     double j,  ///< scale exponent (-1 or 0).
+                     double *l) ///< pointer to the low part.
+{
+  double r, e, k, d, p, h, hl, s, c, s1, c1, s2, c2;
+  x = (x > -40.) ? x : -40.;
+  x = (x < 711.) ? x : 711.;
+  r = batch_math_exp_reduce (x, &k, &e);
+  k += j;
+  d = (k > 1022.) ? k - 1022. : 0.;
+  p = batch_math_pow2 (k - d);
+  h = batch_math_expm1_reduced (r, &hl);
+  s = batch_math_two_sum (p, -batch_math_pow2 (j - d), &c);
+  s1 = batch_math_two_sum (s, p * r, &c1);
+  s2 = batch_math_two_sum (s1, p * h, &c2);
+  h = batch_math_fast_two_sum (s2, (c + c1 + c2) + p * (hl + e), l);
+  p = batch_math_pow2 (d);
+  *l *= p;
+  return h * p;
+}
+
+/**
+ * Function to calculate the exponential function.
+ *
+ * The power of 2 is split in two factors to get the subnormal and the
+ * overflow results.
+ *
+ * \return \f$\exp(x)\f$.
+ */
+static inline double
+batch_math_exp (double x)       ///< argument.
+{
+  double h, l, k, k1, y;
+  y = (x > -746.) ? x : -746.;
+  y = (y < 710.) ? y : 710.;
+  h = batch_math_exp_dd (y, &k, &l);
+  k1 = batch_math_rint (0.5 * k);
+  y = (h + l) * batch_math_pow2 (k1) * batch_math_pow2 (k - k1);
+  return (x == x) ? y : x;
+}
+
+/**
+ * Function to calculate \f$\exp(x)-1\f$ without cancellation near 0.
+ *
+ * \return \f$\exp(x)-1\f$.
+ */
+static inline double
+batch_math_expm1 (double x)     ///< argument.
+{
+  double h, l;
+  h = batch_math_expm1_dd (x, 0., &l);
+  h += l;
+  return (x == x) ? h : x;
+}
+
+/**
+ * Function to calculate the natural logarithm.
+ *
+ * The subnormal numbers are scaled by \f$2^{54}\f$ and the number is
+ * decomposed as \f$x=2^k\,(1+f)\f$ with
+ * \f$\sqrt{2}/2\leq 1+f<\sqrt{2}\f$ and \f$\ln(1+f)=2\,\mathrm{atanh}(s)\f$
+ * with \f$s=f/(2+f)\f$ is calculated by the Taylor polynomial of the
+ * correction term as in fdlibm.
+ *
+ * \return \f$\ln(x)\f$.
+ */
+static inline double
+batch_math_log (double x)       ///< argument.
+{
+  double m, f, s, z, r, h, dk, y;
+  uint64_t i, j;
+  y = (x < 0x1p-1022) ? 0x1p54 * x : x;
+  memcpy (&i, &y, sizeof (double));
+  j = (i >> 52) | 0x4330000000000000ull;
+  memcpy (&dk, &j, sizeof (double));
+  dk -= 0x1p52 + 1023.;
+  dk -= (x < 0x1p-1022) ? 54. : 0.;
+  i = (i & 0x000fffffffffffffull) | 0x3ff0000000000000ull;
+  memcpy (&m, &i, sizeof (double));
+  dk += (m > M_SQRT2) ? 1. : 0.;
+  m = (m > M_SQRT2) ? 0.5 * m : m;
+  f = m - 1.;
+  s = f / (2. + f);
+  z = s * s;
+  r = z * (2. / 3. + z * (2. / 5. + z * (2. / 7. + z * (2. / 9. + z
+           * (2. / 11. + z * (2. / 13. + z * (2. / 15. + z * (2. / 17. + z
+           * (2. / 19. + z * (2. / 21.))))))))));
+  h = 0.5 * f * f;
+  y = dk * BATCH_MATH_LN2_HI
+    - ((h - (s * (h + r) + dk * BATCH_MATH_LN2_LO)) - f);
+  y = (x < INFINITY) ? y : x;
+  y = (x == 0.) ? -INFINITY : y;
+  return (x < 0.) ? NAN : y;
+}
+
+/**
+ * Function to reduce the argument of the trigonometric functions:
+ *   \f$x=k\,\pi/2+r+e\f$ with \f$|r|\leq\pi/4\f$ and the rounding error
+ *   \f$e\f$ of \f$r\f$.
+ *
+ * \return reduced argument.
+ */
+static inline double
+batch_math_trig_reduce (double x,       ///< argument (|x|<2^19 pi/2).
+                        uint64_t * k,   ///< pointer to the quadrant.
+                        double *e)      ///< pointer to the rounding error.
+{
+  double dk, h, l, r;
+  dk = batch_math_rint (x * M_2_PI);
+  *k = batch_math_quadrant (dk);
+  h = x - dk * BATCH_MATH_PIO2_1;
+  l = dk * BATCH_MATH_PIO2_2;
+  r = h - l;
+  l = ((h - r) - l) - dk * BATCH_MATH_PIO2_3;
+  r = batch_math_fast_two_sum (r, l, e);
+  return r;
+}
+
+/**
+ * Function to calculate the sine of \f$r+e\f$ on the reduced interval
+ *   \f$|r|\leq\pi/4\f$ as a double-double number by the Taylor polynomial
+ *   as in the fdlibm kernel.
+ *
+ * \return high part of the sine.
+ */
+static inline double
+batch_math_sin_reduced (double r,       ///< reduced argument.
+                        double e,       ///< rounding error of the argument.
+                        double *l)      ///< pointer to the low part.
+{
+  double z, v, q;
+  z = r * r;
+  v = z * r;
+  q = 1. / 120. + z * (-1. / 5040. + z * (1. / 362880. + z
+      * (-1. / 39916800. + z * (1. / 6227020800. + z
+      * (-1. / 1307674368000. + z * (1. / 355687428096000.))))));
+  return batch_math_fast_two_sum
+    (r, -((z * (0.5 * e - v * q) - e) + v * (1. / 6.)), l);
+}
+
+/**
+ * Function to calculate the cosine of \f$r+e\f$ on the reduced interval
+ *   \f$|r|\leq\pi/4\f$ as a double-double number by the Taylor polynomial
+ *   as in the fdlibm kernel.
+ *
+ * \return high part of the cosine.
+ */
+static inline double
+batch_math_cos_reduced (double r,       ///< reduced argument.
+                        double e,       ///< rounding error of the argument.
+                        double *l)      ///< pointer to the low part.
+{
+  double z, h, w, q;
+  z = r * r;
+  q = 1. / 24. + z * (-1. / 720. + z * (1. / 40320. + z * (-1. / 3628800.
+                 + z * (1. / 479001600. + z * (-1. / 87178291200. + z
+                 * (1. / 20922789888000. + z * (-1. / 6402373705728000.)))))));
+  h = 0.5 * z;
+  w = 1. - h;
+  return batch_math_fast_two_sum
+    (w, ((1. - w) - h) + (z * z * q - r * e), l);
+}
+
+/**
+ * Function to calculate the sine and the cosine.
+ */
+static inline void
+batch_math_sincos (double x,    ///< argument.
+                   double *s,   ///< pointer to the sine.
+                   double *c)   ///< pointer to the cosine.
+{
+  double r, e, sr, cr, l;
+  uint64_t k;
+  r = batch_math_trig_reduce (x, &k, &e);
+  sr = batch_math_sin_reduced (r, e, &l);
+  sr += l;
+  cr = batch_math_cos_reduced (r, e, &l);
+  cr += l;
+  *s = (k == 0) ? sr : (k == 1) ? cr : (k == 2) ? -sr : -cr;
+  *c = (k == 0) ? cr : (k == 1) ? -sr : (k == 2) ? -cr : sr;
+}
+
+/**
+ * Function to calculate the tangent.
+ *
+ * \return \f$\tan(x)\f$.
+ */
+static inline double
+batch_math_tan (double x)       ///< argument.
+{
+  double r, e, sh, sl, ch, cl, nh, nl, dh, dl, h, l;
+  uint64_t k;
+  r = batch_math_trig_reduce (x, &k, &e);
+  sh = batch_math_sin_reduced (r, e, &sl);
+  ch = batch_math_cos_reduced (r, e, &cl);
+  k &= 1;
+  nh = (k) ? -ch : sh;
+  nl = (k) ? -cl : sl;
+  dh = (k) ? sh : ch;
+  dl = (k) ? sl : cl;
+  h = batch_math_dd_div (nh, nl, dh, dl, &l);
+  return h + l;
+}
+
+/**
+ * Function to calculate the arctangent.
+ *
+ * The argument is reduced to \f$|t|\leq 7/16\f$ by the fdlibm intervals and
+ * the Taylor polynomial of the correction term is calculated.
+ *
+ * \return \f$\arctan(x)\f$.
+ */
+static inline double
+batch_math_atan (double x)      ///< argument.
+{
+  double a, n, d, t, z, q, hi, lo, y;
+  a = fabs (x);
+  n = -1.;
+  d = a;
+  hi = 1.57079632679489655800e+00;
+  lo = 6.12323399573676603587e-17;
+  t = a - 1.5;
+  n = (a < 39. / 16.) ? t : n;
+  t = 1. + 1.5 * a;
+  d = (a < 39. / 16.) ? t : d;
+  hi = (a < 39. / 16.) ? 9.82793723247329054082e-01 : hi;
+  lo = (a < 39. / 16.) ? 1.39033110312309984516e-17 : lo;
+  t = a - 1.;
+  n = (a < 19. / 16.) ? t : n;
+  t = a + 1.;
+  d = (a < 19. / 16.) ? t : d;
+  hi = (a < 19. / 16.) ? 7.85398163397448278999e-01 : hi;
+  lo = (a < 19. / 16.) ? 3.06161699786838301793e-17 : lo;
+  t = 2. * a - 1.;
+  n = (a < 11. / 16.) ? t : n;
+  t = 2. + a;
+  d = (a < 11. / 16.) ? t : d;
+  hi = (a < 11. / 16.) ? 4.63647609000806093515e-01 : hi;
+  lo = (a < 11. / 16.) ? 2.26987774529616870924e-17 : lo;
+  n = (a < 7. / 16.) ? a : n;
+  d = (a < 7. / 16.) ? 1. : d;
+  hi = (a < 7. / 16.) ? 0. : hi;
+  lo = (a < 7. / 16.) ? 0. : lo;
+  t = n / d;
+  z = t * t;
+  q = 1. / 3. + z * (-1. / 5. + z * (1. / 7. + z * (-1. / 9. + z
+      * (1. / 11. + z * (-1. / 13. + z * (1. / 15. + z * (-1. / 17. + z
+      * (1. / 19. + z * (-1. / 21. + z * (1. / 23. + z * (-1. / 25. + z
+      * (1. / 27. + z * (-1. / 29. + z * (1. / 31. + z * (-1. / 33. + z
+      * (1. / 35. + z * (-1. / 37. + z * (1. / 39. + z * (-1. / 41. + z
+      * (1. / 43. + z * (-1. / 45.)))))))))))))))))))));
+  y = hi - ((t * z * q - lo) - t);
+  return (x < 0.) ? -y : y;
+}
+
+/**
+ * Function to calculate the hyperbolic cosine.
+ *
+ * \f$\exp(r)+\exp(-r)/2^{2k}\f$ is calculated with \f$|x|=k\,\ln(2)+r\f$
+ * and scaled by \f$2^{k-1}\f$ in two factors as in the exponential function.
+ *
+ * \return \f$\cosh(x)\f$.
+ */
+static inline double
+batch_math_cosh (double x)      ///< argument.
+{
+  double eh, el, ih, il, h, l, k, k1, p, y;
+  y = fabs (x);
+  y = (y < 711.) ? y : 711.;
+  eh = batch_math_exp_dd (y, &k, &el);
+  ih = batch_math_dd_div (1., 0., eh, el, &il);
+  k1 = (k < 511.) ? k : 511.;
+  p = batch_math_pow2 (-2. * k1);
+  h = batch_math_dd_add (eh, el, p * ih, p * il, &l);
+  k -= 1.;
+  k1 = batch_math_rint (0.5 * k);
+  y = (h + l) * batch_math_pow2 (k1) * batch_math_pow2 (k - k1);
+  return (x == x) ? y : x;
+}
+
+/**
+ * Function to calculate the hyperbolic sine.
+ *
+ * \f$\sinh(x)=m+m/(2\,m+1)\f$ is calculated with \f$m=(\exp(|x|)-1)/2\f$,
+ * which does not overflow while \f$\sinh(x)\f$ does not. The quotient is
+ * 1/2 at double-double precision for \f$m>2^{500}\f$, so \f$m\f$ is clamped
+ * there to avoid the overflow of the Dekker splitting.
+ *
+ * \return \f$\sinh(x)\f$.
+ */
+static inline double
+batch_math_sinh (double x)      ///< argument.
+{
+  double mh, ml, ch, cl, dh, dl, h, l, y;
+  mh = batch_math_expm1_dd (fabs (x), -1., &ml);
+  ch = (mh < 0x1p500) ? mh : 0x1p500;
+  cl = (mh < 0x1p500) ? ml : 0.;
+  dh = batch_math_dd_add (ch, cl, 0.5, 0., &dl);
+  h = batch_math_dd_div (ch, cl, dh, dl, &l);
+  h = batch_math_dd_add (mh, ml, 0.5 * h, 0.5 * l, &l);
+  y = h + l;
+  y = (mh < INFINITY) ? y : mh;
+  y = (x < 0.) ? -y : y;
+  return (x == x) ? y : x;
+}
+
+/**
+ * Function to calculate the hyperbolic tangent.
+ *
+ * \return \f$\tanh(x)\f$.
+ */
+static inline double
+batch_math_tanh (double x)      ///< argument.
+{
+  double mh, ml, dh, dl, h, l, y;
+  mh = 2. * fabs (x);
+  mh = (mh < 40.) ? mh : 40.;
+  mh = batch_math_expm1_dd (mh, 0., &ml);
+  dh = batch_math_dd_add (mh, ml, 2., 0., &dl);
+  h = batch_math_dd_div (mh, ml, dh, dl, &l);
+  y = h + l;
+  y = (x < 0.) ? -y : y;
+  return (x == x) ? y : x;
+}
+
+/**
+ * Function to calculate the exponential function of an array.
+ */
+CPU_DISPATCH void
+batch_exp (const double *x,     ///< array of arguments.
+           double *y,           ///< array of results.
+           unsigned int n)      ///< number of elements.
+{
+  unsigned int i;
+  for (i = 0; i < n; ++i)
+    y[i] = batch_math_exp (x[i]);
+}
+
+/**
+ * Function to calculate \f$\exp(x)-1\f$ on an array.
+ */
+CPU_DISPATCH void
+batch_expm1 (const double *x,   ///< array of arguments.
+             double *y,         ///< array of results.
+             unsigned int n)    ///< number of elements.
+{
+  unsigned int i;
+  for (i = 0; i < n; ++i)
+    y[i] = batch_math_expm1 (x[i]);
+}
+
+/**
+ * Function to calculate the natural logarithm of an array.
+ */
+CPU_DISPATCH void
+batch_log (const double *x,     ///< array of arguments.
+           double *y,           ///< array of results.
+           unsigned int n)      ///< number of elements.
+{
+  unsigned int i;
+  for (i = 0; i < n; ++i)
+    y[i] = batch_math_log (x[i]);
+}
+
+/**
+ * Function to calculate the sine and the cosine of an array.
+ */
+CPU_DISPATCH void
+batch_sincos (const double *x,  ///< array of arguments.
+              double *s,        ///< array of sines.
+              double *c,        ///< array of cosines.
+              unsigned int n)   ///< number of elements.
+{
+  unsigned int i;
+  for (i = 0; i < n; ++i)
+    batch_math_sincos (x[i], s + i, c + i);
+}
+
+/**
+ * Function to calculate the tangent of an array.
+ */
+CPU_DISPATCH void
+batch_tan (const double *x,     ///< array of arguments.
+           double *y,           ///< array of results.
+           unsigned int n)      ///< number of elements.
+{
+  unsigned int i;
+  for (i = 0; i < n; ++i)
+    y[i] = batch_math_tan (x[i]);
+}
+
+/**
+ * Function to calculate the arctangent of an array.
+ */
+CPU_DISPATCH void
+batch_atan (const double *x,    ///< array of arguments.
+            double *y,          ///< array of results.
+            unsigned int n)     ///< number of elements.
+{
+  unsigned int i;
+  for (i = 0; i < n; ++i)
+    y[i] = batch_math_atan (x[i]);
+}
+
+/**
+ * Function to calculate the hyperbolic cosine of an array.
+ */
+CPU_DISPATCH void
+batch_cosh (const double *x,    ///< array of arguments.
+            double *y,          ///< array of results.
+            unsigned int n)     ///< number of elements.
+{
+  unsigned int i;
+  for (i = 0; i < n; ++i)
+    y[i] = batch_math_cosh (x[i]);
+}
+
+/**
+ * Function to calculate the hyperbolic sine of an array.
+ */
+CPU_DISPATCH void
+batch_sinh (const double *x,    ///< array of arguments.
+            double *y,          ///< array of results.
+            unsigned int n)     ///< number of elements.
+{
+  unsigned int i;
+  for (i = 0; i < n; ++i)
+    y[i] = batch_math_sinh (x[i]);
+}
+
+/**
+ * Function to calculate the hyperbolic tangent of an array.
+ */
+CPU_DISPATCH void
+batch_tanh (const double *x,    ///< array of arguments.
+            double *y,          ///< array of results.
+            unsigned int n)     ///< number of elements.
+{
+  unsigned int i;
+  for (i = 0; i < n; ++i)
+    y[i] = batch_math_tanh (x[i]);
+}
@@ -0,0 +1,50 @@
+/*
+Ballistic: a software to benchmark ballistic models.
+
+AUTHORS: Javier Burguete Tolosa.
+
+Copyright 2018, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+/**
+ * \file batch-math.h
+ * \brief Header file to define the vectorizable mathematical functions on
+ *   arrays.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2018.
+ */
+#ifndef BATCH_MATH__H
+#define BATCH_MATH__H 1
+
+void batch_exp (const double *x, double *y, unsigned int n);
+void batch_expm1 (const double *x, double *y, unsigned int n);
+void batch_log (const double *x, double *y, unsigned int n);
+void batch_sincos (const double *x, double *s, double *c, unsigned int n);
+void batch_tan (const double *x, double *y, unsigned int n);
+void batch_atan (const double *x, double *y, unsigned int n);
+void batch_cosh (const double *x, double *y, unsigned int n);
+void batch_sinh (const double *x, double *y, unsigned int n);
+void batch_tanh (const double *x, double *y, unsigned int n);
+
+#endif
@@ -38,24 +38,53 @@ OF SUCH DAMAGE.
 
 #define G 9.81L                 ///< gravitational constant.
 
+#if defined(__x86_64__) && defined(__ELF__) && defined(__GNUC__) \
+  && !defined(__clang__)
+#define CPU_DISPATCH \
+  __attribute__ ((target_clones ("avx512f", "avx2", "default")))
+///< macro to compile a function for several instruction sets selected at
+///< startup by the CPU features.
+#else
+#define CPU_DISPATCH
+///< macro to compile a function for several instruction sets (disabled).
+#endif
+
 #define XML_ALPHA          (const xmlChar*)"alpha"
 ///< XML alpha label.
 #define XML_BALLISTIC      (const xmlChar*)"ballistic"
 ///< XML ballistic label.
+#define XML_BATCH          (const xmlChar*)"batch"
+///< XML batch label.
 #define XML_BETA           (const xmlChar*)"beta"
 ///< XML beta label.
+#define XML_CONFIDENCE     (const xmlChar*)"confidence"
+///< XML confidence label.
+#define XML_CONTROL_TRAJECTORIES (const xmlChar*)"control-trajectories"
+///< XML control-trajectories label.
+#define XML_CONTROL_VARIATE (const xmlChar*)"control-variate"
+///< XML control-variate label.
 #define XML_CONVERGENCE    (const xmlChar*)"convergence"
 ///< XML convergence label.
+#define XML_COST_TRAJECTORIES (const xmlChar*)"cost-trajectories"
+///< XML cost-trajectories label.
+#define XML_DECADE_POINTS  (const xmlChar*)"decade-points"
+///< XML decade-points label.
 #define XML_DT             (const xmlChar*)"dt"
 ///< XML dt label.
 #define XML_EQUATION       (const xmlChar*)"equation"
 ///< XML equation label.
+#define XML_ERROR_MAX      (const xmlChar*)"error-max"
+///< XML error-max label.
 #define XML_ERROR_TIME     (const xmlChar*)"error_time"
 ///< XML error-time label.
 #define XML_FACTOR         (const xmlChar*)"factor"
 ///< XML factor label.
 #define XML_G              (const xmlChar*)"g"
 ///< XML g label.
+#define XML_HALTON         (const xmlChar*)"halton"
+///< XML halton label.
+#define XML_INTEGRATION_THREADS (const xmlChar*)"integration-threads"
+///< XML integration-threads label.
 #define XML_KT             (const xmlChar*)"kt"
 ///< XML kt label.
 #define XML_LAMBDA         (const xmlChar*)"lambda"
@@ -66,14 +95,44 @@ OF SUCH DAMAGE.
 ///< XML lambda-max label.
 #define XML_LAND           (const xmlChar*)"land"
 ///< XML land label.
+#define XML_LOW_STORAGE    (const xmlChar*)"low-storage"
+///< XML low-storage label.
+#define XML_MIN_ORDER      (const xmlChar*)"min-order"
+///< XML min-order label.
+#define XML_MLMC_ERROR     (const xmlChar*)"mlmc-error"
+///< XML mlmc-error label.
 #define XML_MULTI_STEPS    (const xmlChar*)"multi-steps"
 ///< XML multi-steps label.
+#define XML_OFFSET         (const xmlChar*)"offset"
+///< XML offset label.
+#define XML_PHILOX         (const xmlChar*)"philox"
+///< XML philox label.
+#define XML_RANDOM         (const xmlChar*)"random"
+///< XML random label.
+#define XML_REFERENCE_THREADS (const xmlChar*)"reference-threads"
+///< XML reference-threads label.
+#define XML_RELATIVE_PRECISION (const xmlChar*)"relative-precision"
+///< XML relative-precision label.
 #define XML_RUNGE_KUTTA    (const xmlChar*)"runge-kutta"
 ///< XML runge-kutta label.
+#define XML_SAMPLING       (const xmlChar*)"sampling"
+///< XML sampling label.
+#define XML_SCRAMBLE       (const xmlChar*)"scramble"
+///< XML scramble label.
+#define XML_SEED           (const xmlChar*)"seed"
+///< XML seed label.
+#define XML_SOBOL          (const xmlChar*)"sobol"
+///< XML sobol label.
+#define XML_SORT           (const xmlChar*)"sort"
+///< XML sort label.
 #define XML_STEPS          (const xmlChar*)"steps"
 ///< XML steps label.
 #define XML_T              (const xmlChar*)"t"
 ///< XML t label.
+#define XML_TARGET_ERROR   (const xmlChar*)"target-error"
+///< XML target-error label.
+#define XML_THREADS        (const xmlChar*)"threads"
+///< XML threads label.
 #define XML_TIME_STEP      (const xmlChar*)"time-step"
 ///< XML time-step label.
 #define XML_TRAJECTORIES   (const xmlChar*)"trajectories"
@@ -0,0 +1,446 @@
+/*
+Ballistic: a software to benchmark ballistic models.
+
+AUTHORS: Javier Burguete Tolosa.
+
+Copyright 2018, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+/**
+ * \file equation-inline.h
+ * \brief Header file with the inline equation functions used on every step.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2018.
+ */
+#ifndef EQUATION_INLINE__H
+#define EQUATION_INLINE__H 1
+
+#define DEBUG_EQUATION_INLINE 0
+///< macro to debug the inline equation functions.
+
+/**
+ * Function to calculate the acceleration on non-resitance model.
+ *
+ * This function calculates the acceleration vector on a non-resistance
+ * model. The movement equation is:
+ * \f{equation}\ddot{\vec{r}}=\vec{g}\f}
+ * with \f$\vec{g}=(0,\;0,\;-g)\f$ the gravity field vector.
+ */
+static inline void
+equation_acceleration_0 (Equation * eq __attribute__ ((unused)),
+                         ///< Equation struct.
+                         long double *r0 __attribute__ ((unused)),
+                         ///< position vector.
+                         long double *r1 __attribute__ ((unused)),
+                         ///< velocity vector.
+                         long double *r2,       ///< acceleration vector.
+                         long double t __attribute__ ((unused)))
+  ///< actual time.
+{
+#if DEBUG_EQUATION_INLINE
+  fprintf (stderr, "equation_acceleration_0: start\n");
+#endif
+  r2[0] = r2[1] = 0.L;
+  r2[2] = -G;
+  ++nevaluations;
+#if DEBUG_EQUATION_INLINE
+  fprintf (stderr, "equation_acceleration_0: ax=%Lg ay=%Lg az=%Lg\n",
+           r2[0], r2[1], r2[2]);
+  fprintf (stderr, "equation_acceleration_0: end\n");
+#endif
+}
+
+/**
+ * Function to calculate the acceleration on the 1st resistance model.
+ *
+ * This function calculates the acceleration vector on a resistance model
+ * model characterized by the movement equation:
+ * \f[\ddot{\vec{r}}=\vec{g}-\lambda\,\left(\dot{\vec{r}}-\vec{w}\right)\f]
+ * with \f$\vec{g}=(0,\;0,\;-g)\f$ the gravity field vector,
+ * \f$\vec{w}=\left(w_x,\;w_y\;0\right)\f$ the wind velocity vector and
+ * \f$\lambda\f$ a resistance coefficient.
+ */
+static inline void
+equation_acceleration_1 (Equation * eq, ///< Equation struct.
+                         long double *r0 __attribute__ ((unused)),
+                         ///< position vector.
+                         long double *r1,       ///< velocity vector.
+                         long double *r2,       ///< acceleration vector.
+                         long double t __attribute__ ((unused)))
+  ///< actual time.
+{
+#if DEBUG_EQUATION_INLINE
+  fprintf (stderr, "equation_acceleration_1: start\n");
+#endif
+  r2[0] = -eq->lambda * (r1[0] - eq->w[0]);
+  r2[1] = -eq->lambda * (r1[1] - eq->w[1]);
+  r2[2] = -eq->g - eq->lambda * r1[2];
+  ++nevaluations;
+#if DEBUG_EQUATION_INLINE
+  fprintf (stderr, "equation_acceleration_1: ax=%Lg ay=%Lg az=%Lg\n",
+           r2[0], r2[1], r2[2]);
+  fprintf (stderr, "equation_acceleration_1: end\n");
+#endif
+}
+
+/**
+ * Function to calculate the acceleration on 2nd resistance model.
+ *
+ * This function calculates the acceleration vector on a resistance model
+ * model characterized by the movement equations:
+ * \f[\left.\begin{array}{r}
+ * \ddot{x}=-\lambda\,\left|\dot{x}-w_x\right|\,\left(\dot{x}-w_x\right),\\
+ * \ddot{y}=-\lambda\,\left|\dot{y}-w_y\right|\,\left(\dot{y}-w_y\right),\\
+ * \ddot{z}=-g-\lambda\,\left|\dot{z}\right|\,\dot{z},
+ * \end{array}\right\}\f]
+ * with g the gravitational constant, \f$w_x\f$ and \f$w_y\f$ the wind velocity
+ * vector components and \f$\lambda\f$ a resistance coefficient.
+ */
+static inline void
+equation_acceleration_2 (Equation * eq, ///< Equation struct.
+                         long double *r0 __attribute__ ((unused)),
+                         ///< position vector.
+                         long double *r1,       ///< velocity vector.
+                         long double *r2,       ///< acceleration vector.
+                         long double t __attribute__ ((unused)))
+  ///< actual time.
+{
+  long double v[2];
+#if DEBUG_EQUATION_INLINE
+  fprintf (stderr, "equation_acceleration_2: start\n");
+#endif
+  v[0] = r1[0] - eq->w[0];
+  v[1] = r1[1] - eq->w[1];
+  r2[0] = -eq->lambda * fabsl (v[0]) * v[0];
+  r2[1] = -eq->lambda * fabsl (v[1]) * v[1];
+  r2[2] = -eq->g - eq->lambda * fabsl (r1[2]) * r1[2];
+  ++nevaluations;
+#if DEBUG_EQUATION_INLINE
+  fprintf (stderr, "equation_acceleration_2: ax=%Lg ay=%Lg az=%Lg\n",
+           r2[0], r2[1], r2[2]);
+  fprintf (stderr, "equation_acceleration_2: end\n");
+#endif
+}
+
+/**
+ * Function to calculate the acceleration on a forced model.
+ *
+ * This function calculates the acceleration vector on a forced model. The
+ * movement equation is:
+ * \f{equation}
+ * \ddot{\vec{r}}=\vec{g}+\vec{w}\,\exp\left(-\lambda\,t\right)
+ * \f}
+ * with \f$\vec{g}=(0,\;0,\;-g)\f$ the gravity field vector, \f$\lambda\f$ the
+ * force decay factor and \f$\vec{w}=\left(w_x,\;w_y\;0\right)\f$ the force
+ * vector.
+ */
+static inline void
+equation_acceleration_3 (Equation * eq, ///< Equation struct.
+                         long double *r0 __attribute__ ((unused)),
+                         ///< position vector.
+                         long double *r1 __attribute__ ((unused)),
+                         ///< velocity vector.
+                         long double *r2,       ///< acceleration vector.
+                         long double t) ///< actual time.
+{
+  long double elt;
+#if DEBUG_EQUATION_INLINE
+  fprintf (stderr, "equation_acceleration_3: start\n");
+#endif
+  elt = expl (-eq->lambda * t);
+  r2[0] = eq->w[0] * elt;
+  r2[1] = eq->w[1] * elt;
+  r2[2] = -G;
+  ++nevaluations;
+#if DEBUG_EQUATION_INLINE
+  fprintf (stderr, "equation_acceleration_3: ax=%Lg ay=%Lg az=%Lg\n",
+           r2[0], r2[1], r2[2]);
+  fprintf (stderr, "equation_acceleration_3: end\n");
+#endif
+}
+
+/**
+ * Function to set a constant time step size.
+ *
+ * \return time step size.
+ */
+static inline long double
+equation_step_size_0 (Equation * eq __attribute__ ((unused)))
+///< Equation struct.
+{
+#if DEBUG_EQUATION_INLINE
+  fprintf (stderr, "equation_step_size_0: start\n");
+  fprintf (stderr, "equation_step_size_0: dt=%Lg\n", dt);
+  fprintf (stderr, "equation_step_size_0: end\n");
+#endif
+  return dt;
+}
+
+/**
+ * Function to set the time step size based on stability condition for the 1st
+ * resistance model.
+ *
+ * \return time step size.
+ */
+static inline long double
+equation_step_size_1 (Equation * eq)    ///< Equation struct.
+{
+  long double dt;
+#if DEBUG_EQUATION_INLINE
+  fprintf (stderr, "equation_step_size_1: start\n");
+#endif
+  dt = kt / fabsl (eq->lambda);
+#if DEBUG_EQUATION_INLINE
+  fprintf (stderr, "equation_step_size_1: dt=%Lg\n", dt);
+  fprintf (stderr, "equation_step_size_1: end\n");
+#endif
+  return dt;
+}
+
+/**
+ * Function to set the time step size based on stability condition for the 2nd
+ * resistance model.
+ *
+ * \return time step size.
+ */
+static inline long double
+equation_step_size_2 (Equation * eq)    ///< Equation struct.
+{
+  long double dt;
+#if DEBUG_EQUATION_INLINE
+  fprintf (stderr, "equation_step_size_2: start\n");
+#endif
+  dt = kt / (fabsl (eq->lambda) *
+             fmaxl (fabsl (r1[0] - eq->w[0]),
+                    fmaxl (fabsl (r1[1] - eq->w[1]), fabsl (r1[2]))));
+#if DEBUG_EQUATION_INLINE
+  fprintf (stderr, "equation_step_size_2: dt=%Lg\n", dt);
+  fprintf (stderr, "equation_step_size_2: end\n");
+#endif
+  return dt;
+}
+
+/**
+ * Function to finish the trajectory based on final time.
+ *
+ * \return 1 on finish, 0 on continuing.
+ */
+static inline int
+equation_land_0 (Equation * eq, ///< Equation struct.
+                 long double to,        ///< old time.
+                 long double *t,        ///< next time.
+                 long double *dt)       ///< time step size.
+{
+  long double tf;
+#if DEBUG_EQUATION_INLINE
+  fprintf (stderr, "equation_land_0: start\n");
+  fprintf (stderr, "equation_land_0: to=%Lg\n", to);
+#endif
+  tf = eq->tf;
+  if (to >= tf)
+    {
+#if DEBUG_EQUATION_INLINE
+      fprintf (stderr, "equation_land_0: landing\n");
+      fprintf (stderr, "equation_land_0: end\n");
+#endif
+      return 1;
+    }
+  *t = to + *dt;
+  if (*t >= tf)
+    {
+      *dt = tf - to;
+      *t = tf;
+    }
+#if DEBUG_EQUATION_INLINE
+  fprintf (stderr, "equation_land_0: t=%Lg dt=%Lg\n", *t, *dt);
+  fprintf (stderr, "equation_land_0: no landing\n");
+  fprintf (stderr, "equation_land_0: end\n");
+#endif
+  return 0;
+}
+
+/**
+ * Function to finish the trajectory based on 1st order landing.
+ *
+ * \return 1 on finish, 0 on continuing.
+ */
+static inline int
+equation_land_1 (Equation * eq __attribute__ ((unused)),
+                 ///< Equation struct.
+                 long double to,        ///< old time.
+                 long double *t,        ///< next time.
+                 long double *dt)       ///< time step size.
+{
+  long double h;
+#if DEBUG_EQUATION_INLINE
+  fprintf (stderr, "equation_land_1: start\n");
+  fprintf (stderr, "equation_land_1: to=%Lg\n", to);
+#endif
+  if (r0[2] > 0.)
+    {
+      *t = to + *dt;
+#if DEBUG_EQUATION_INLINE
+      fprintf (stderr, "equation_land_1: t=%Lg dt=%Lg\n", *t, *dt);
+      fprintf (stderr, "equation_land_1: no landing\n");
+      fprintf (stderr, "equation_land_1: end\n");
+#endif
+      return 0;
+    }
+  h = r0[2] / r1[2];
+  r0[0] -= h * r1[0];
+  r0[1] -= h * r1[1];
+  r0[2] -= h * r1[2];
+  r1[0] -= h * r2[0];
+  r1[1] -= h * r2[1];
+  r1[2] -= h * r2[2];
+  *t = to - h;
+#if DEBUG_EQUATION_INLINE
+  fprintf (stderr, "equation_land_1: t=%Lg dt=%Lg\n", *t, *dt);
+  fprintf (stderr, "equation_land_1: landing\n");
+  fprintf (stderr, "equation_land_1: end\n");
+#endif
+  return 1;
+}
+
+/**
+ * Function to finish the trajectory based on 2nd order landing.
+ *
+ * \return 1 on finish, 0 on continuing.
+ */
+static inline int
+equation_land_2 (Equation * eq __attribute__ ((unused)),
+                 ///< Equation struct.
+                 long double to,        ///< old time.
+                 long double *t,        ///< next time.
+                 long double *dt)       ///< time step size.
+{
+  long double h;
+#if DEBUG_EQUATION_INLINE
+  fprintf (stderr, "equation_land_2: start\n");
+  fprintf (stderr, "equation_land_2: to=%Lg\n", to);
+#endif
+  if (r0[2] > 0.)
+    {
+      *t = to + *dt;
+#if DEBUG_EQUATION_INLINE
+      fprintf (stderr, "equation_land_2: t=%Lg dt=%Lg\n", *t, *dt);
+      fprintf (stderr, "equation_land_2: no landing\n");
+      fprintf (stderr, "equation_land_2: end\n");
+#endif
+      return 0;
+    }
+  h = solve_quadratic (0.5L * r2[2], -r1[2], r0[2], 0.L, *dt);
+  r0[0] -= h * (r1[0] - h * 0.5L * r2[0]);
+  r0[1] -= h * (r1[1] - h * 0.5L * r2[1]);
+  r0[2] -= h * (r1[2] - h * 0.5L * r2[2]);
+  r1[0] -= h * r2[0];
+  r1[1] -= h * r2[1];
+  r1[2] -= h * r2[2];
+  *t = to - h;
+#if DEBUG_EQUATION_INLINE
+  fprintf (stderr, "equation_land_2: t=%Lg dt=%Lg\n", *t, *dt);
+  fprintf (stderr, "equation_land_2: landing\n");
+  fprintf (stderr, "equation_land_2: end\n");
+#endif
+  return 1;
+}
+
+/**
+ * Function to finish the trajectory based on 3rd order landing.
+ *
+ * \return 1 on finish, 0 on continuing.
+ */
+static inline int
+equation_land_3 (Equation * eq __attribute__ ((unused)),
+                 ///< Equation struct.
+                 long double to,        ///< old time.
+                 long double *t,        ///< next time.
+                 long double *dt)       ///< time step size.
+{
+  long double h, r3[3];
+#if DEBUG_EQUATION_INLINE
+  fprintf (stderr, "equation_land_3: start\n");
+  fprintf (stderr, "equation_land_3: to=%Lg\n", to);
+#endif
+  if (r0[2] > 0.)
+    {
+      *t = to + *dt;
+#if DEBUG_EQUATION_INLINE
+      fprintf (stderr, "equation_land_3: t=%Lg dt=%Lg\n", *t, *dt);
+      fprintf (stderr, "equation_land_3: no landing\n");
+      fprintf (stderr, "equation_land_3: end\n");
+#endif
+      return 0;
+    }
+  r3[0] = (r2[0] - ro2[0]) / *dt;
+  r3[1] = (r2[1] - ro2[1]) / *dt;
+  r3[2] = (r2[2] - ro2[2]) / *dt;
+  h = solve_cubic (-1.L / 6.L * r3[2], 0.5L * r2[2], -r1[2], r0[2], 0.L, *dt);
+  r0[0] -= h * (r1[0] - h * (0.5L * r2[0] - h * 1.L / 6.L * r3[0]));
+  r0[1] -= h * (r1[1] - h * (0.5L * r2[1] - h * 1.L / 6.L * r3[1]));
+  r0[2] -= h * (r1[2] - h * (0.5L * r2[2] - h * 1.L / 6.L * r3[2]));
+  r1[0] -= h * (r2[0] - h * 0.5L * r3[0]);
+  r1[1] -= h * (r2[1] - h * 0.5L * r3[1]);
+  r1[2] -= h * (r2[2] - h * 0.5L * r3[2]);
+  *t = to - h;
+#if DEBUG_EQUATION_INLINE
+  fprintf (stderr, "equation_land_3: t=%Lg dt=%Lg\n", *t, *dt);
+  fprintf (stderr, "equation_land_3: landing\n");
+  fprintf (stderr, "equation_land_3: end\n");
+#endif
+  return 1;
+}
+
+/**
+ * Function to get the index of the time step size function.
+ *
+ * \return 0 on constant time step size, the equation type otherwise.
+ */
+static inline unsigned int
+equation_step_size_type (Equation * eq) ///< Equation struct.
+{
+  return (eq->size_type) ? eq->type : 0;
+}
+
+#define EQUATION_SPECIALIZE_ERROR(M, type, land, size) \
+  M (type, land, size, 0) \
+  M (type, land, size, 1)
+///< macro to expand a macro on the error control types.
+#define EQUATION_SPECIALIZE_LAND(M, type, size) \
+  EQUATION_SPECIALIZE_ERROR (M, type, 0, size) \
+  EQUATION_SPECIALIZE_ERROR (M, type, 1, size) \
+  EQUATION_SPECIALIZE_ERROR (M, type, 2, size) \
+  EQUATION_SPECIALIZE_ERROR (M, type, 3, size)
+///< macro to expand a macro on the landing types.
+#define EQUATION_SPECIALIZE(M) \
+  EQUATION_SPECIALIZE_LAND (M, 0, 0) \
+  EQUATION_SPECIALIZE_LAND (M, 1, 0) \
+  EQUATION_SPECIALIZE_LAND (M, 1, 1) \
+  EQUATION_SPECIALIZE_LAND (M, 2, 0) \
+  EQUATION_SPECIALIZE_LAND (M, 2, 2) \
+  EQUATION_SPECIALIZE_LAND (M, 3, 0)
+///< macro to expand a macro on every valid combination of equation type,
+///< landing type, time step size function and error control type.
+
+#endif
@@ -39,18 +39,48 @@ OF SUCH DAMAGE.
 #include <math.h>
 #include <gsl/gsl_rng.h>
 #include <libxml/parser.h>
+#include <glib.h>
 #include "config.h"
 #include "utils.h"
+#include "batch-math.h"
 #include "equation.h"
+#include "equation-inline.h"
 
 #define DEBUG_EQUATION 0        ///< macro to debug the equation functions.
 
-long double r0[3];              ///< position vector.
-long double r1[3];              ///< velocity vector.
-long double r2[3];              ///< acceleration vector.
-long double ro0[3];             ///< backup of the position vector.
-long double ro1[3];             ///< backup of the velocity vector.
-long double ro2[3];             ///< backup of the acceleration vector.
+#define EQUATION_BATCH_VZ 0
+///< index of the column of vertical velocities of a batch.
+#define EQUATION_BATCH_LAMBDA 1
+///< index of the column of friction coefficients of a batch.
+#define EQUATION_BATCH_LI 2
+///< index of the column of inverse friction coefficients of a batch.
+#define EQUATION_BATCH_GL 3
+///< index of the column of square roots of g by lambda of a batch.
+#define EQUATION_BATCH_G_L 4
+///< index of the column of square roots of g by 1/lambda of a batch.
+#define EQUATION_BATCH_ALPHA 5
+///< index of the column of alpha angles of a batch.
+#define EQUATION_BATCH_TC 6
+///< index of the column of maximum height times of a batch.
+#define EQUATION_BATCH_CALPHA 7
+///< index of the column of cosines of alpha of a batch.
+#define EQUATION_BATCH_COLUMNS 8
+///< maximum number of columns of the vertical movement of a batch.
+#define EQUATION_BATCH_WORK 6
+///< number of work columns of a batch.
+
+_Thread_local long double r0[3];
+///< position vector of the thread.
+_Thread_local long double r1[3];
+///< velocity vector of the thread.
+_Thread_local long double r2[3];
+///< acceleration vector of the thread.
+_Thread_local long double ro0[3];
+///< backup of the position vector of the thread.
+_Thread_local long double ro1[3];
+///< backup of the velocity vector of the thread.
+_Thread_local long double ro2[3];
+///< backup of the acceleration vector of the thread.
 void (*equation_acceleration) (Equation * eq, long double *r0,
                                long double *r1, long double *r2, long double t);
 ///< pointer to the function to calculate the acceleration.
@@ -66,40 +96,8 @@ long double kt;
 ///< stability time step size coefficient.
 long double dt;
 ///< time step size.
-unsigned long int nevaluations;
-///< number of evaluations of the acceleration function.
-
-/**
- * Function to calculate the acceleration on non-resitance model.
- *
- * This function calculates the acceleration vector on a non-resistance
- * model. The movement equation is:
- * \f{equation}\ddot{\vec{r}}=\vec{g}\f}
- * with \f$\vec{g}=(0,\;0,\;-g)\f$ the gravity field vector.
- */
-static void
-equation_acceleration_0 (Equation * eq __attribute__ ((unused)),
-                         ///< Equation struct.
-                         long double *r0 __attribute__ ((unused)),
-                         ///< position vector.
-                         long double *r1 __attribute__ ((unused)),
-                         ///< velocity vector.
-                         long double *r2,       ///< acceleration vector.
-                         long double t __attribute__ ((unused)))
-  ///< actual time.
-{
-#if DEBUG_EQUATION
-  fprintf (stderr, "equation_acceleration_0: start\n");
-#endif
-  r2[0] = r2[1] = 0.L;
-  r2[2] = -G;
-  ++nevaluations;
-#if DEBUG_EQUATION
-  fprintf (stderr, "equation_acceleration_0: ax=%Lg ay=%Lg az=%Lg\n",
-           r2[0], r2[1], r2[2]);
-  fprintf (stderr, "equation_acceleration_0: end\n");
-#endif
-}
+_Thread_local unsigned long int nevaluations;
+///< number of evaluations of the acceleration function of the thread.
 
 /**
  * Function to solve the non-resistance model.
@@ -112,7 +110,7 @@ equation_acceleration_0 (Equation * eq __attribute__ ((unused)),
  * \f{equation}\dot{\vec{r}}=\dot{\vec{r}}_0+\vec{g}\,t,\f}
  * \f{equation}\vec{r}=\vec{r}_0+\dot{\vec{r}}_0\,t+\frac12\,\vec{g}\,t^2.\f}
  */
-static void
+static CPU_DISPATCH void
 equation_solution_0 (Equation * eq,     ///< Equation struct.
                      long double *r0,   ///< position vector.
                      long double *r1,   ///< velocity vector.
@@ -136,39 +134,6 @@ equation_solution_0 (Equation * eq,     ///< Equation struct.
 #endif
 }
 
-/**
- * Function to calculate the acceleration on the 1st resistance model.
- *
- * This function calculates the acceleration vector on a resistance model
- * model characterized by the movement equation:
- * \f[\ddot{\vec{r}}=\vec{g}-\lambda\,\left(\dot{\vec{r}}-\vec{w}\right)\f]
- * with \f$\vec{g}=(0,\;0,\;-g)\f$ the gravity field vector,
- * \f$\vec{w}=\left(w_x,\;w_y\;0\right)\f$ the wind velocity vector and
- * \f$\lambda\f$ a resistance coefficient.
- */
-static void
-equation_acceleration_1 (Equation * eq, ///< Equation struct.
-                         long double *r0 __attribute__ ((unused)),
-                         ///< position vector.
-                         long double *r1,       ///< velocity vector.
-                         long double *r2,       ///< acceleration vector.
-                         long double t __attribute__ ((unused)))
-  ///< actual time.
-{
-#if DEBUG_EQUATION
-  fprintf (stderr, "equation_acceleration_1: start\n");
-#endif
-  r2[0] = -eq->lambda * (r1[0] - eq->w[0]);
-  r2[1] = -eq->lambda * (r1[1] - eq->w[1]);
-  r2[2] = -eq->g - eq->lambda * r1[2];
-  ++nevaluations;
-#if DEBUG_EQUATION
-  fprintf (stderr, "equation_acceleration_1: ax=%Lg ay=%Lg az=%Lg\n",
-           r2[0], r2[1], r2[2]);
-  fprintf (stderr, "equation_acceleration_1: end\n");
-#endif
-}
-
 /**
  * Function to solve the 1st resistance model.
  *
@@ -192,7 +157,7 @@ equation_acceleration_1 (Equation * eq, ///< Equation struct.
  * \,\left[1-\exp\left(-\lambda\,t\right)\right].
  * \f}
  */
-static void
+static CPU_DISPATCH void
 equation_solution_1 (Equation * eq,     ///< Equation struct.
                      long double *r0,   ///< position vector.
                      long double *r1,   ///< velocity vector.
@@ -208,7 +173,7 @@ equation_solution_1 (Equation * eq,     ///< Equation struct.
   elt = expl (-eq->lambda * t);
   r1[0] = eq->w[0] + v[0] * elt;
   r1[1] = eq->w[1] + v[1] * elt;
-  li = 1.L / eq->lambda;
+  li = eq->li;
   gl = eq->g * li;
   r1[2] = (eq->v[2] + gl) * elt - gl;
   k = li * (1.L - elt);
@@ -224,45 +189,6 @@ equation_solution_1 (Equation * eq,     ///< Equation struct.
 #endif
 }
 
-/**
- * Function to calculate the acceleration on 2nd resistance model.
- *
- * This function calculates the acceleration vector on a resistance model
- * model characterized by the movement equations:
- * \f[\left.\begin{array}{r}
- * \ddot{x}=-\lambda\,\left|\dot{x}-w_x\right|\,\left(\dot{x}-w_x\right),\\
- * \ddot{y}=-\lambda\,\left|\dot{y}-w_y\right|\,\left(\dot{y}-w_y\right),\\
- * \ddot{z}=-g-\lambda\,\left|\dot{z}\right|\,\dot{z},
- * \end{array}\right\}\f]
- * with g the gravitational constant, \f$w_x\f$ and \f$w_y\f$ the wind velocity
- * vector components and \f$\lambda\f$ a resistance coefficient.
- */
-static void
-equation_acceleration_2 (Equation * eq, ///< Equation struct.
-                         long double *r0 __attribute__ ((unused)),
-                         ///< position vector.
-                         long double *r1,       ///< velocity vector.
-                         long double *r2,       ///< acceleration vector.
-                         long double t __attribute__ ((unused)))
-  ///< actual time.
-{
-  long double v[2];
-#if DEBUG_EQUATION
-  fprintf (stderr, "equation_acceleration_2: start\n");
-#endif
-  v[0] = r1[0] - eq->w[0];
-  v[1] = r1[1] - eq->w[1];
-  r2[0] = -eq->lambda * fabsl (v[0]) * v[0];
-  r2[1] = -eq->lambda * fabsl (v[1]) * v[1];
-  r2[2] = -eq->g - eq->lambda * fabsl (r1[2]) * r1[2];
-  ++nevaluations;
-#if DEBUG_EQUATION
-  fprintf (stderr, "equation_acceleration_2: ax=%Lg ay=%Lg az=%Lg\n",
-           r2[0], r2[1], r2[2]);
-  fprintf (stderr, "equation_acceleration_2: end\n");
-#endif
-}
-
 /**
  * Function to solve the 2nd resistance mode.
  *
@@ -332,14 +258,14 @@ equation_acceleration_2 (Equation * eq, ///< Equation struct.
  * \end{array}\right.
  * \f}
  */
-static void
+static CPU_DISPATCH void
 equation_solution_2 (Equation * eq,     ///< Equation struct.
                      long double *r0,   ///< position vector.
                      long double *r1,   ///< velocity vector.
                      long double t)     ///< actual time.
 {
   long double v[2], k[2];
-  long double tc, g_l, gl, glt, lt, li, alpha;
+  long double g_l, gl, glt, lt, li, alpha;
 #if DEBUG_EQUATION
   fprintf (stderr, "equation_solution_2: start\n");
 #endif
@@ -350,7 +276,7 @@ equation_solution_2 (Equation * eq,     ///< Equation struct.
   k[1] = 1.L + lt * fabsl (v[1]);
   r1[0] = eq->w[0] + v[0] / k[0];
   r1[1] = eq->w[1] + v[1] / k[1];
-  li = 1.L / eq->lambda;
+  li = eq->li;
   k[0] = li * logl (k[0]);
   k[1] = li * logl (k[1]);
   r0[0] = eq->r[0] + eq->w[0] * t;
@@ -363,9 +289,9 @@ equation_solution_2 (Equation * eq,     ///< Equation struct.
     r0[1] += k[1];
   else
     r0[1] -= k[1];
-  gl = sqrtl (eq->g * eq->lambda);
+  gl = eq->gl;
   glt = gl * t;
-  g_l = sqrtl (eq->g / eq->lambda);
+  g_l = eq->g_l;
   r0[2] = eq->r[2];
   if (eq->v[2] <= 0.L)
     {
@@ -377,19 +303,18 @@ equation_solution_2 (Equation * eq,     ///< Equation struct.
     }
   else
     {
-      alpha = atanl (eq->v[2] / g_l);
-      tc = alpha / gl;
-      if (t <= tc)
+      alpha = eq->alpha;
+      if (t <= eq->tc)
         {
           r1[2] = g_l * tanl (alpha - glt);
-          r0[2] += li * logl (cosl (alpha - glt) / cosl (alpha));
+          r0[2] += li * logl (cosl (alpha - glt) / eq->calpha);
         }
       else
         {
-          t -= tc;
+          t -= eq->tc;
           glt = gl * t;
           r1[2] = -g_l * tanhl (glt);
-          r0[2] -= li * logl (cosl (alpha) * coshl (glt));
+          r0[2] -= li * logl (eq->calpha * coshl (glt));
         }
     }
 #if DEBUG_EQUATION
@@ -401,43 +326,6 @@ equation_solution_2 (Equation * eq,     ///< Equation struct.
 #endif
 }
 
-/**
- * Function to calculate the acceleration on a forced model.
- *
- * This function calculates the acceleration vector on a forced model. The
- * movement equation is:
- * \f{equation}
- * \ddot{\vec{r}}=\vec{g}+\vec{w}\,\exp\left(-\lambda\,t\right)
- * \f}
- * with \f$\vec{g}=(0,\;0,\;-g)\f$ the gravity field vector, \f$\lambda\f$ the
- * force decay factor and \f$\vec{w}=\left(w_x,\;w_y\;0\right)\f$ the force
- * vector.
- */
-static void
-equation_acceleration_3 (Equation * eq, ///< Equation struct.
-                         long double *r0 __attribute__ ((unused)),
-                         ///< position vector.
-                         long double *r1 __attribute__ ((unused)),
-                         ///< velocity vector.
-                         long double *r2,       ///< acceleration vector.
-                         long double t) ///< actual time.
-{
-  long double elt;
-#if DEBUG_EQUATION
-  fprintf (stderr, "equation_acceleration_3: start\n");
-#endif
-  elt = expl (-eq->lambda * t);
-  r2[0] = eq->w[0] * elt;
-  r2[1] = eq->w[1] * elt;
-  r2[2] = -G;
-  ++nevaluations;
-#if DEBUG_EQUATION
-  fprintf (stderr, "equation_acceleration_3: ax=%Lg ay=%Lg az=%Lg\n",
-           r2[0], r2[1], r2[2]);
-  fprintf (stderr, "equation_acceleration_3: end\n");
-#endif
-}
-
 /**
  * Function to solve the forced model.
  *
@@ -459,7 +347,7 @@ equation_acceleration_3 (Equation * eq, ///< Equation struct.
  * +\frac{\vec{w}}{\lambda^2}\,\left[1-\exp\left(-\lambda\,t\right)\right].
  * \f}
  */
-static void
+static CPU_DISPATCH void
 equation_solution_3 (Equation * eq,     ///< Equation struct.
                      long double *r0,   ///< position vector.
                      long double *r1,   ///< velocity vector.
@@ -469,7 +357,7 @@ equation_solution_3 (Equation * eq,     ///< Equation struct.
 #if DEBUG_EQUATION
   fprintf (stderr, "equation_solution_3: start\n");
 #endif
-  li = 1.L / eq->lambda;
+  li = eq->li;
   k = li * (1.L - expl (-eq->lambda * t));
   r1[0] = eq->v[0] + eq->w[0] * k;
   r1[1] = eq->v[1] + eq->w[1] * k;
@@ -488,20 +376,26 @@ equation_solution_3 (Equation * eq,     ///< Equation struct.
 }
 
 /**
- * Function to solve numerically the equation by the mean point method.
+ * Function to solve numerically the landing of an analytical solution by the
+ *   mean point method.
  *
  * \return solution time.
  */
-long double
-equation_solve (Equation * eq,  ///< Equation struct.
-                long double *r0,        ///< position vector solution.
-                long double *r1)        ///< velocity vector solution.
+static inline long double
+equation_solve_solution (Equation * eq, ///< Equation struct.
+                         void (*equation_solution) (Equation * eq,
+                                                    long double *r0,
+                                                    long double *r1,
+                                                    long double t),
+                         ///< pointer to the analytical solution function.
+                         long double *r0,       ///< position vector solution.
+                         long double *r1)       ///< velocity vector solution.
 {
   long double r02[3], r12[3];
   long double t1, t2, t3;
   unsigned int i;
 #if DEBUG_EQUATION
-  fprintf (stderr, "equation_solve: start\n");
+  fprintf (stderr, "equation_solve_solution: start\n");
 #endif
   t1 = 0.L;
   t2 = 1.L;
@@ -523,281 +417,615 @@ equation_solve (Equation * eq,  ///< Equation struct.
   memcpy (r0, r02, 3 * sizeof (long double));
   memcpy (r1, r12, 3 * sizeof (long double));
 #if DEBUG_EQUATION
-  fprintf (stderr, "equation_solve: vx=%Lg vy=%Lg vz=%Lg\n",
+  fprintf (stderr, "equation_solve_solution: vx=%Lg vy=%Lg vz=%Lg\n",
            r1[0], r1[1], r1[2]);
-  fprintf (stderr, "equation_solve: x=%Lg y=%Lg z=%Lg\n", r0[0], r0[1], r0[2]);
-  fprintf (stderr, "equation_solve: t=%Lg\n", t3);
-  fprintf (stderr, "equation_solve: end\n");
+  fprintf (stderr, "equation_solve_solution: x=%Lg y=%Lg z=%Lg\n",
+           r0[0], r0[1], r0[2]);
+  fprintf (stderr, "equation_solve_solution: t=%Lg\n", t3);
+  fprintf (stderr, "equation_solve_solution: end\n");
 #endif
   return t3;
 }
 
 /**
- * Function to set a constant time step size.
+ * Function to solve numerically the equation by the mean point method.
  *
- * \return time step size.
+ * \return solution time.
  */
-static long double
-equation_step_size_0 (Equation * eq __attribute__ ((unused)))
-///< Equation struct.
+long double
+equation_solve (Equation * eq,  ///< Equation struct.
+                long double *r0,        ///< position vector solution.
+                long double *r1)        ///< velocity vector solution.
 {
-#if DEBUG_EQUATION
-  fprintf (stderr, "equation_step_size_0: start\n");
-  fprintf (stderr, "equation_step_size_0: dt=%Lg\n", dt);
-  fprintf (stderr, "equation_step_size_0: end\n");
-#endif
-  return dt;
+  return equation_solve_solution (eq, equation_solution, r0, r1);
 }
 
 /**
- * Function to set the time step size based on stability condition for the 1st
- * resistance model.
+ * Function to calculate the final solution of an analytical surrogate model
+ *   with the same initial conditions, wind and friction coefficient.
+ *
+ * The surrogate model (1: 1st resistance model, 2: 2nd resistance model) is
+ * solved at the final time on the time landing type or at the landing point on
+ * the other landing types. The equation must not be a non-resistance model.
  *
- * \return time step size.
+ * \return solution time.
  */
-static long double
-equation_step_size_1 (Equation * eq)    ///< Equation struct.
+long double
+equation_surrogate (Equation * eq,      ///< Equation struct.
+                    unsigned int type,  ///< surrogate model type.
+                    long double *r0,    ///< position vector solution.
+                    long double *r1)    ///< velocity vector solution.
 {
-  long double dt;
+  Equation es[1];
+  void (*solution) (Equation * eq, long double *r0, long double *r1,
+                    long double t);
 #if DEBUG_EQUATION
-  fprintf (stderr, "equation_step_size_1: start\n");
+  fprintf (stderr, "equation_surrogate: start\n");
 #endif
-  dt = kt / fabsl (eq->lambda);
+  memcpy (es, eq, sizeof (Equation));
+  es->type = type;
+  equation_invariants (es);
+  if (type == 1)
+    solution = equation_solution_1;
+  else
+    solution = equation_solution_2;
+  if (!eq->land_type)
+    {
+      solution (es, r0, r1, eq->tf);
+#if DEBUG_EQUATION
+      fprintf (stderr, "equation_surrogate: end\n");
+#endif
+      return eq->tf;
+    }
 #if DEBUG_EQUATION
-  fprintf (stderr, "equation_step_size_1: dt=%Lg\n", dt);
-  fprintf (stderr, "equation_step_size_1: end\n");
+  fprintf (stderr, "equation_surrogate: end\n");
 #endif
-  return dt;
+  return equation_solve_solution (es, solution, r0, r1);
 }
 
 /**
- * Function to set the time step size based on stability condition for the 2nd
- * resistance model.
+ * Function to calculate the invariants of a trajectory.
  *
- * \return time step size.
+ * The values depending only on the initial conditions and on the friction
+ * coefficient are calculated once per trajectory to avoid recalculating them
+ * on every evaluation of the analytical solution.
  */
-static long double
-equation_step_size_2 (Equation * eq)    ///< Equation struct.
+void
+equation_invariants (Equation * eq)     ///< Equation struct.
 {
-  long double dt;
 #if DEBUG_EQUATION
-  fprintf (stderr, "equation_step_size_2: start\n");
+  fprintf (stderr, "equation_invariants: start\n");
 #endif
-  dt = kt / (fabsl (eq->lambda) *
-             fmaxl (fabsl (r1[0] - eq->w[0]),
-                    fmaxl (fabsl (r1[1] - eq->w[1]), fabsl (r1[2]))));
+  switch (eq->type)
+    {
+    case 2:
+      eq->gl = sqrtl (eq->g * eq->lambda);
+      eq->g_l = sqrtl (eq->g / eq->lambda);
+      eq->alpha = atanl (eq->v[2] / eq->g_l);
+      eq->tc = eq->alpha / eq->gl;
+      eq->calpha = cosl (eq->alpha);
+      // fall through
+    case 1:
+    case 3:
+      eq->li = 1.L / eq->lambda;
+    }
 #if DEBUG_EQUATION
-  fprintf (stderr, "equation_step_size_2: dt=%Lg\n", dt);
-  fprintf (stderr, "equation_step_size_2: end\n");
+  fprintf (stderr, "equation_invariants: li=%Lg gl=%Lg g_l=%Lg\n",
+           eq->li, eq->gl, eq->g_l);
+  fprintf (stderr, "equation_invariants: alpha=%Lg tc=%Lg\n",
+           eq->alpha, eq->tc);
+  fprintf (stderr, "equation_invariants: end\n");
 #endif
-  return dt;
 }
 
 /**
- * Function to finish the trajectory based on final time.
+ * Function to init the equation variables.
  *
- * \return 1 on finish, 0 on continuing.
+ * The random variables are obtained from an array of uniform numbers in
+ * \f$[0,\;1)\f$: u[0] for the friction coefficient (not used on the
+ * non-resistance model), u[1] for the velocity, u[2] for the horizontal angle,
+ * u[3] for the wind velocity and u[4] for the wind direction.
  */
-static int
-equation_land_0 (Equation * eq, ///< Equation struct.
-                 long double to,        ///< old time.
-                 long double *t,        ///< next time.
-                 long double *dt)       ///< time step size.
+void
+equation_init (Equation * eq,   ///< Equation struct.
+               const double *u) ///< array of uniform random numbers.
 {
-  long double tf;
+  long double v, ha;
 #if DEBUG_EQUATION
-  fprintf (stderr, "equation_land_0: start\n");
-  fprintf (stderr, "equation_land_0: to=%Lg\n", to);
+  fprintf (stderr, "equation_init: start\n");
 #endif
-  tf = eq->tf;
-  if (to >= tf)
+  switch (eq->type)
     {
+    case 1:
+    case 2:
+    case 3:
+      eq->lambda = eq->min_lambda + (eq->max_lambda - eq->min_lambda) * u[0];
+    }
+  v = eq->min_velocity + (eq->max_velocity - eq->min_velocity) * u[1];
+  ha = 2.L * M_PIl * u[2];
+  eq->r[0] = eq->r[1] = 0.L;
+  eq->v[2] = v * eq->vertical_sin;
+  eq->v[1] = v * eq->vertical_cos;
+  eq->v[0] = eq->v[1] * cosl (ha);
+  eq->v[1] *= sinl (ha);
+  v = eq->max_wind * u[3];
+  ha = 2.L * M_PIl * u[4];
+  eq->w[0] = v * cosl (ha);
+  eq->w[1] = v * sinl (ha);
+  equation_invariants (eq);
 #if DEBUG_EQUATION
-      fprintf (stderr, "equation_land_0: landing\n");
-      fprintf (stderr, "equation_land_0: end\n");
+  fprintf (stderr, "equation_init: end\n");
 #endif
-      return 1;
+}
+
+/**
+ * Function to init the variables of a batch of trajectories.
+ *
+ * This function does the same transformation than the equation_init function
+ * on columns of n uniform numbers (u[j*n+i] is the j-th number of the i-th
+ * trajectory) but in double precision and without function calls on the
+ * inner loops, so they can be vectorized. The results are stored on the
+ * columns of the x array: friction coefficient (not used on the
+ * non-resistance model), velocity vector and wind velocity vector.
+ */
+CPU_DISPATCH void
+equation_init_batch (Equation * eq,     ///< Equation struct.
+                     const double *u,   ///< array of uniform random numbers.
+                     unsigned int n,    ///< number of trajectories.
+                     double *x) ///< array of initial conditions.
+{
+  double *lambda, *vx, *vy, *vz, *wx, *wy;
+  double lmin, dl, vmin, dv, vs, vc, wmax, v;
+  unsigned int i;
+#if DEBUG_EQUATION
+  fprintf (stderr, "equation_init_batch: start\n");
+#endif
+  lambda = x;
+  vx = x + n;
+  vy = vx + n;
+  vz = vy + n;
+  wx = vz + n;
+  wy = wx + n;
+  switch (eq->type)
+    {
+    case 1:
+    case 2:
+    case 3:
+      lmin = (double) eq->min_lambda;
+      dl = (double) (eq->max_lambda - eq->min_lambda);
+      for (i = 0; i < n; ++i)
+        lambda[i] = lmin + dl * u[i];
     }
-  *t = to + *dt;
-  if (*t >= tf)
+  vmin = (double) eq->min_velocity;
+  dv = (double) (eq->max_velocity - eq->min_velocity);
+  vs = (double) eq->vertical_sin;
+  vc = (double) eq->vertical_cos;
+  sincos_2pi (u + 2 * n, vy, vx, n);
+  for (i = 0; i < n; ++i)
     {
-      *dt = tf - to;
-      *t = tf;
+      v = vmin + dv * u[n + i];
+      vz[i] = v * vs;
+      v *= vc;
+      vx[i] *= v;
+      vy[i] *= v;
+    }
+  wmax = (double) eq->max_wind;
+  sincos_2pi (u + 4 * n, wy, wx, n);
+  for (i = 0; i < n; ++i)
+    {
+      v = wmax * u[3 * n + i];
+      wx[i] *= v;
+      wy[i] *= v;
     }
 #if DEBUG_EQUATION
-  fprintf (stderr, "equation_land_0: t=%Lg dt=%Lg\n", *t, *dt);
-  fprintf (stderr, "equation_land_0: no landing\n");
-  fprintf (stderr, "equation_land_0: end\n");
+  fprintf (stderr, "equation_init_batch: end\n");
 #endif
-  return 0;
 }
 
 /**
- * Function to finish the trajectory based on 1st order landing.
+ * Function to get the number of columns of the vertical movement of a batch.
  *
- * \return 1 on finish, 0 on continuing.
+ * \return number of columns.
  */
-static int
-equation_land_1 (Equation * eq __attribute__ ((unused)),
-                 ///< Equation struct.
-                 long double to,        ///< old time.
-                 long double *t,        ///< next time.
-                 long double *dt)       ///< time step size.
+static inline unsigned int
+equation_batch_columns (Equation * eq)  ///< Equation struct.
 {
-  long double h;
-#if DEBUG_EQUATION
-  fprintf (stderr, "equation_land_1: start\n");
-  fprintf (stderr, "equation_land_1: to=%Lg\n", to);
-#endif
-  if (r0[2] > 0.)
+  switch (eq->type)
     {
-      *t = to + *dt;
+    case 0:
+      return 1;
+    case 2:
+      return EQUATION_BATCH_COLUMNS;
+    }
+  return 3;
+}
+
+/**
+ * Function to calculate the columns of the vertical movement of a batch.
+ *
+ * The vertical velocities, the friction coefficients and the invariants of
+ * every trajectory are calculated in double precision as in the
+ * equation_invariants function.
+ */
+static CPU_DISPATCH void
+equation_invariants_batch (Equation * eq,       ///< Equation struct.
+                           const double *x,
+                           ///< array of initial conditions.
+                           unsigned int n,      ///< number of trajectories.
+                           double **c,  ///< array of columns.
+                           double *w)   ///< work column.
+{
+  const double *lambda;
+  double *li, *gl, *g_l, *alpha, *tc, *calpha;
+  double g;
+  unsigned int i;
 #if DEBUG_EQUATION
-      fprintf (stderr, "equation_land_1: t=%Lg dt=%Lg\n", *t, *dt);
-      fprintf (stderr, "equation_land_1: no landing\n");
-      fprintf (stderr, "equation_land_1: end\n");
+  fprintf (stderr, "equation_invariants_batch: start\n");
 #endif
-      return 0;
+  memcpy (c[EQUATION_BATCH_VZ], x + 3 * n, n * sizeof (double));
+  if (!eq->type)
+    goto end;
+  lambda = x;
+  li = c[EQUATION_BATCH_LI];
+  memcpy (c[EQUATION_BATCH_LAMBDA], lambda, n * sizeof (double));
+  for (i = 0; i < n; ++i)
+    li[i] = 1. / lambda[i];
+  if (eq->type != 2)
+    goto end;
+  g = (double) eq->g;
+  gl = c[EQUATION_BATCH_GL];
+  g_l = c[EQUATION_BATCH_G_L];
+  alpha = c[EQUATION_BATCH_ALPHA];
+  tc = c[EQUATION_BATCH_TC];
+  calpha = c[EQUATION_BATCH_CALPHA];
+  for (i = 0; i < n; ++i)
+    {
+      gl[i] = sqrt (g * lambda[i]);
+      g_l[i] = sqrt (g * li[i]);
+      w[i] = x[3 * n + i] / g_l[i];
     }
-  h = r0[2] / r1[2];
-  r0[0] -= h * r1[0];
-  r0[1] -= h * r1[1];
-  r0[2] -= h * r1[2];
-  r1[0] -= h * r2[0];
-  r1[1] -= h * r2[1];
-  r1[2] -= h * r2[2];
-  *t = to - h;
+  batch_atan (w, alpha, n);
+  for (i = 0; i < n; ++i)
+    tc[i] = alpha[i] / gl[i];
+  batch_sincos (alpha, w, calpha, n);
+end:
 #if DEBUG_EQUATION
-  fprintf (stderr, "equation_land_1: t=%Lg dt=%Lg\n", *t, *dt);
-  fprintf (stderr, "equation_land_1: landing\n");
-  fprintf (stderr, "equation_land_1: end\n");
+  fprintf (stderr, "equation_invariants_batch: end\n");
 #endif
-  return 1;
+  return;
 }
 
 /**
- * Function to finish the trajectory based on 2nd order landing.
+ * Function to calculate the height and the vertical velocity of a batch of
+ *   trajectories.
  *
- * \return 1 on finish, 0 on continuing.
+ * On the 2nd resistance model the three branches of the analytical solution
+ * are selected per trajectory, so the loops have not branches: the hyperbolic
+ * functions are calculated with a null argument on the ascending branch and
+ * the trigonometric functions with a null argument on the others.
  */
-static int
-equation_land_2 (Equation * eq __attribute__ ((unused)),
-                 ///< Equation struct.
-                 long double to,        ///< old time.
-                 long double *t,        ///< next time.
-                 long double *dt)       ///< time step size.
+static CPU_DISPATCH void
+equation_vertical_batch (Equation * eq, ///< Equation struct.
+                         double **c,    ///< array of columns.
+                         const double *t,       ///< array of times.
+                         unsigned int n,        ///< number of trajectories.
+                         double *z,     ///< array of heights.
+                         double *vz,
+                         ///< array of vertical velocities (NULL: none).
+                         double *w)     ///< array of work columns.
 {
-  long double h;
+  const double *v, *lambda, *li, *gl, *g_l, *alpha, *tc, *calpha;
+  double *h, *q, *ch, *sh, *s, *co;
+  double g, z0, glt, a, b, k;
+  unsigned int i;
 #if DEBUG_EQUATION
-  fprintf (stderr, "equation_land_2: start\n");
-  fprintf (stderr, "equation_land_2: to=%Lg\n", to);
+  fprintf (stderr, "equation_vertical_batch: start\n");
 #endif
-  if (r0[2] > 0.)
+  v = c[EQUATION_BATCH_VZ];
+  lambda = c[EQUATION_BATCH_LAMBDA];
+  li = c[EQUATION_BATCH_LI];
+  g = (double) eq->g;
+  z0 = (double) eq->r[2];
+  switch (eq->type)
     {
-      *t = to + *dt;
-#if DEBUG_EQUATION
-      fprintf (stderr, "equation_land_2: t=%Lg dt=%Lg\n", *t, *dt);
-      fprintf (stderr, "equation_land_2: no landing\n");
-      fprintf (stderr, "equation_land_2: end\n");
-#endif
-      return 0;
+    case 0:
+    case 3:
+      for (i = 0; i < n; ++i)
+        z[i] = z0 + t[i] * (v[i] - t[i] * 0.5 * (double) G);
+      if (vz)
+        for (i = 0; i < n; ++i)
+          vz[i] = v[i] - g * t[i];
+      break;
+    case 1:
+      for (i = 0; i < n; ++i)
+        w[i] = -lambda[i] * t[i];
+      batch_expm1 (w, w, n);
+      for (i = 0; i < n; ++i)
+        {
+          k = g * li[i];
+          z[i] = z0 - k * t[i] - (v[i] + k) * li[i] * w[i];
+        }
+      if (vz)
+        for (i = 0; i < n; ++i)
+          {
+            k = g * li[i];
+            vz[i] = (v[i] + k) * (1. + w[i]) - k;
+          }
+      break;
+    default:
+      gl = c[EQUATION_BATCH_GL];
+      g_l = c[EQUATION_BATCH_G_L];
+      alpha = c[EQUATION_BATCH_ALPHA];
+      tc = c[EQUATION_BATCH_TC];
+      calpha = c[EQUATION_BATCH_CALPHA];
+      h = w;
+      q = h + n;
+      ch = q + n;
+      sh = ch + n;
+      s = sh + n;
+      co = s + n;
+      for (i = 0; i < n; ++i)
+        {
+          glt = gl[i] * t[i];
+          a = gl[i] * (t[i] - tc[i]);
+          b = alpha[i] - glt;
+          h[i] = (v[i] <= 0.) ? glt : (t[i] > tc[i]) ? a : 0.;
+          q[i] = (v[i] > 0. && t[i] <= tc[i]) ? b : 0.;
+        }
+      batch_cosh (h, ch, n);
+      batch_sinh (h, sh, n);
+      batch_sincos (q, s, co, n);
+      for (i = 0; i < n; ++i)
+        {
+          a = ch[i] - v[i] * sh[i] / g_l[i];
+          b = co[i] / calpha[i];
+          k = calpha[i] * ch[i];
+          h[i] = (v[i] <= 0.) ? a : (t[i] <= tc[i]) ? b : k;
+        }
+      batch_log (h, h, n);
+      for (i = 0; i < n; ++i)
+        {
+          k = (v[i] > 0. && t[i] <= tc[i]) ? li[i] : -li[i];
+          z[i] = z0 + k * h[i];
+        }
+      if (vz)
+        for (i = 0; i < n; ++i)
+          {
+            a = g_l[i] * (v[i] * ch[i] - g_l[i] * sh[i])
+              / (g_l[i] * ch[i] - v[i] * sh[i]);
+            b = g_l[i] * s[i] / co[i];
+            k = -g_l[i] * sh[i] / ch[i];
+            vz[i] = (v[i] <= 0.) ? a : (t[i] <= tc[i]) ? b : k;
+          }
     }
-  h = solve_quadratic (0.5L * r2[2], -r1[2], r0[2], 0.L, *dt);
-  r0[0] -= h * (r1[0] - h * 0.5L * r2[0]);
-  r0[1] -= h * (r1[1] - h * 0.5L * r2[1]);
-  r0[2] -= h * (r1[2] - h * 0.5L * r2[2]);
-  r1[0] -= h * r2[0];
-  r1[1] -= h * r2[1];
-  r1[2] -= h * r2[2];
-  *t = to - h;
 #if DEBUG_EQUATION
-  fprintf (stderr, "equation_land_2: t=%Lg dt=%Lg\n", *t, *dt);
-  fprintf (stderr, "equation_land_2: landing\n");
-  fprintf (stderr, "equation_land_2: end\n");
+  fprintf (stderr, "equation_vertical_batch: end\n");
 #endif
-  return 1;
 }
 
 /**
- * Function to finish the trajectory based on 3rd order landing.
- *
- * \return 1 on finish, 0 on continuing.
+ * Function to calculate the horizontal position and velocity of a batch of
+ *   trajectories.
  */
-static int
-equation_land_3 (Equation * eq __attribute__ ((unused)),
-                 ///< Equation struct.
-                 long double to,        ///< old time.
-                 long double *t,        ///< next time.
-                 long double *dt)       ///< time step size.
+static CPU_DISPATCH void
+equation_horizontal_batch (Equation * eq,       ///< Equation struct.
+                           const double *x,
+                           ///< array of initial conditions.
+                           double **c,  ///< array of columns.
+                           const double *t,     ///< array of times.
+                           unsigned int n,      ///< number of trajectories.
+                           double *y,   ///< array of solutions.
+                           double *w)   ///< array of work columns.
 {
-  long double h, r3[3];
+  const double *lambda, *li, *v[2], *wv[2];
+  double *r[2], *r1[2], *k[2];
+  double r0[2], vr, l;
+  unsigned int i, j;
 #if DEBUG_EQUATION
-  fprintf (stderr, "equation_land_3: start\n");
-  fprintf (stderr, "equation_land_3: to=%Lg\n", to);
+  fprintf (stderr, "equation_horizontal_batch: start\n");
 #endif
-  if (r0[2] > 0.)
+  lambda = c[EQUATION_BATCH_LAMBDA];
+  li = c[EQUATION_BATCH_LI];
+  for (j = 0; j < 2; ++j)
+    {
+      v[j] = x + (j + 1) * n;
+      wv[j] = x + (j + 4) * n;
+      r[j] = y + j * n;
+      r1[j] = y + (j + 3) * n;
+      r0[j] = (double) eq->r[j];
+    }
+  switch (eq->type)
     {
-      *t = to + *dt;
+    case 0:
+      for (j = 0; j < 2; ++j)
+        for (i = 0; i < n; ++i)
+          {
+            r1[j][i] = v[j][i];
+            r[j][i] = r0[j] + v[j][i] * t[i];
+          }
+      break;
+    case 1:
+      for (i = 0; i < n; ++i)
+        w[i] = -lambda[i] * t[i];
+      batch_expm1 (w, w, n);
+      for (j = 0; j < 2; ++j)
+        for (i = 0; i < n; ++i)
+          {
+            vr = v[j][i] - wv[j][i];
+            r1[j][i] = wv[j][i] + vr * (1. + w[i]);
+            r[j][i] = r0[j] + wv[j][i] * t[i] - vr * li[i] * w[i];
+          }
+      break;
+    case 2:
+      for (j = 0; j < 2; ++j)
+        {
+          k[j] = w + j * n;
+          for (i = 0; i < n; ++i)
+            {
+              vr = v[j][i] - wv[j][i];
+              k[j][i] = 1. + lambda[i] * t[i] * fabs (vr);
+              r1[j][i] = wv[j][i] + vr / k[j][i];
+            }
+          batch_log (k[j], k[j], n);
+          for (i = 0; i < n; ++i)
+            {
+              vr = v[j][i] - wv[j][i];
+              l = li[i] * k[j][i];
+              r[j][i] = r0[j] + wv[j][i] * t[i] + ((vr >= 0.) ? l : -l);
+            }
+        }
+      break;
+    default:
+      for (i = 0; i < n; ++i)
+        w[i] = -lambda[i] * t[i];
+      batch_expm1 (w, w, n);
+      for (j = 0; j < 2; ++j)
+        for (i = 0; i < n; ++i)
+          {
+            l = -li[i] * w[i];
+            r1[j][i] = v[j][i] + wv[j][i] * l;
+            r[j][i] = r0[j] + (v[j][i] + wv[j][i] * li[i]) * t[i]
+              - wv[j][i] * li[i] * l;
+          }
+    }
 #if DEBUG_EQUATION
-      fprintf (stderr, "equation_land_3: t=%Lg dt=%Lg\n", *t, *dt);
-      fprintf (stderr, "equation_land_3: no landing\n");
-      fprintf (stderr, "equation_land_3: end\n");
+  fprintf (stderr, "equation_horizontal_batch: end\n");
 #endif
-      return 0;
-    }
-  r3[0] = (r2[0] - ro2[0]) / *dt;
-  r3[1] = (r2[1] - ro2[1]) / *dt;
-  r3[2] = (r2[2] - ro2[2]) / *dt;
-  h = solve_cubic (-1.L / 6.L * r3[2], 0.5L * r2[2], -r1[2], r0[2], 0.L, *dt);
-  r0[0] -= h * (r1[0] - h * (0.5L * r2[0] - h * 1.L / 6.L * r3[0]));
-  r0[1] -= h * (r1[1] - h * (0.5L * r2[1] - h * 1.L / 6.L * r3[1]));
-  r0[2] -= h * (r1[2] - h * (0.5L * r2[2] - h * 1.L / 6.L * r3[2]));
-  r1[0] -= h * (r2[0] - h * 0.5L * r3[0]);
-  r1[1] -= h * (r2[1] - h * 0.5L * r3[1]);
-  r1[2] -= h * (r2[2] - h * 0.5L * r3[2]);
-  *t = to - h;
+}
+
+/**
+ * Function to calculate the analytical solution of a batch of trajectories.
+ *
+ * The initial conditions are the columns of n numbers calculated by the
+ * equation_init_batch function and the initial position is the one of the
+ * Equation struct. The results are stored on the columns of the y array:
+ * position vector and velocity vector. The solution is calculated in double
+ * precision by vectorizable loops.
+ */
+CPU_DISPATCH void
+equation_solution_batch (Equation * eq, ///< Equation struct.
+                         const double *x,       ///< array of initial conditions.
+                         const double *t,       ///< array of times.
+                         unsigned int n,        ///< number of trajectories.
+                         double *y)     ///< array of solutions.
+{
+  double *c[EQUATION_BATCH_COLUMNS];
+  double *w;
+  unsigned int i, nc;
 #if DEBUG_EQUATION
-  fprintf (stderr, "equation_land_3: t=%Lg dt=%Lg\n", *t, *dt);
-  fprintf (stderr, "equation_land_3: landing\n");
-  fprintf (stderr, "equation_land_3: end\n");
+  fprintf (stderr, "equation_solution_batch: start\n");
+#endif
+  nc = equation_batch_columns (eq);
+  w = (double *) g_malloc ((nc + EQUATION_BATCH_WORK) * (size_t) n
+                           * sizeof (double));
+  for (i = 0; i < EQUATION_BATCH_COLUMNS; ++i)
+    c[i] = (i < nc) ? w + (EQUATION_BATCH_WORK + i) * (size_t) n : NULL;
+  equation_invariants_batch (eq, x, n, c, w);
+  equation_horizontal_batch (eq, x, c, t, n, y, w);
+  equation_vertical_batch (eq, c, t, n, y + 2 * n, y + 5 * n, w);
+  g_free (w);
+#if DEBUG_EQUATION
+  fprintf (stderr, "equation_solution_batch: end\n");
 #endif
-  return 1;
 }
 
 /**
- * Function to init the equation variables.
+ * Function to solve numerically the landing of a batch of trajectories by
+ *   the mean point method.
+ *
+ * The landing times are bracketed by doubling the upper time and refined by
+ * bisection until the interval can not be divided in double precision. The
+ * trajectories are iterated together on columns, so the height is calculated
+ * by the vectorizable functions. The finished trajectories are removed from
+ * the columns after every iteration, so they do not contribute more work.
+ * Then, the solutions at the landing times are calculated as in the
+ * equation_solution_batch function.
  */
-void
-equation_init (Equation * eq,   ///< Equation struct.
-               gsl_rng * rng)   ///< gsl_rng struct.
+CPU_DISPATCH void
+equation_solve_batch (Equation * eq,    ///< Equation struct.
+                      const double *x,  ///< array of initial conditions.
+                      unsigned int n,   ///< number of trajectories.
+                      double *t,        ///< array of landing times.
+                      double *y)        ///< array of solutions.
 {
-  long double v, ha, va;
+  double *c[EQUATION_BATCH_COLUMNS], *a[EQUATION_BATCH_COLUMNS];
+  double *w, *t1, *t2, *t3, *z, *bracket;
+  unsigned int *index;
+  unsigned int i, j, k, m, nc;
 #if DEBUG_EQUATION
-  fprintf (stderr, "equation_init: start\n");
+  fprintf (stderr, "equation_solve_batch: start\n");
 #endif
-  switch (eq->type)
+  nc = equation_batch_columns (eq);
+  w = (double *) g_malloc ((2 * nc + EQUATION_BATCH_WORK + 5) * (size_t) n
+                           * sizeof (double));
+  for (i = 0; i < EQUATION_BATCH_COLUMNS; ++i)
+    c[i] = a[i] = NULL;
+  for (i = 0; i < nc; ++i)
     {
-    case 1:
-    case 2:
-    case 3:
-      eq->lambda = eq->min_lambda
-        + (eq->max_lambda - eq->min_lambda) * gsl_rng_uniform (rng);
+      c[i] = w + (EQUATION_BATCH_WORK + i) * (size_t) n;
+      a[i] = c[i] + nc * (size_t) n;
     }
-  v = eq->min_velocity
-    + (eq->max_velocity - eq->min_velocity) * gsl_rng_uniform (rng);
-  ha = 2.L * M_PIl * gsl_rng_uniform (rng);
-  eq->r[0] = eq->r[1] = 0.L;
-  va = eq->vertical_angle * M_PIl / 180.L;
-  eq->v[2] = v * sinl (va);
-  eq->v[1] = v * cosl (va);
-  eq->v[0] = eq->v[1] * cosl (ha);
-  eq->v[1] *= sinl (ha);
-  v = eq->max_wind * gsl_rng_uniform (rng);
-  ha = 2.L * M_PIl * gsl_rng_uniform (rng);
-  eq->w[0] = v * cosl (ha);
-  eq->w[1] = v * sinl (ha);
+  t1 = w + (EQUATION_BATCH_WORK + 2 * nc) * (size_t) n;
+  t2 = t1 + n;
+  t3 = t2 + n;
+  z = t3 + n;
+  bracket = z + n;
+  index = (unsigned int *) g_malloc (n * sizeof (unsigned int));
+  equation_invariants_batch (eq, x, n, c, w);
+  for (i = 0; i < nc; ++i)
+    memcpy (a[i], c[i], n * sizeof (double));
+  for (k = 0; k < n; ++k)
+    {
+      index[k] = k;
+      t1[k] = 0.;
+      t2[k] = 1.;
+      bracket[k] = 1.;
+    }
+  for (m = n; m > 0; m = j)
+    {
+      for (k = 0; k < m; ++k)
+        t3[k] = (bracket[k] > 0.) ? t2[k] : 0.5 * (t1[k] + t2[k]);
+      equation_vertical_batch (eq, a, t3, m, z, NULL, w);
+      for (j = k = 0; k < m; ++k)
+        {
+          if (bracket[k] > 0.)
+            {
+              if (z[k] > 0.)
+                {
+                  t1[k] = t2[k];
+                  t2[k] *= 2.;
+                }
+              else
+                bracket[k] = 0.;
+            }
+          else if (z[k] > 0.)
+            t1[k] = t3[k];
+          else
+            t2[k] = t3[k];
+          t3[k] = 0.5 * (t1[k] + t2[k]);
+          if (bracket[k] == 0. && (t3[k] <= t1[k] || t3[k] >= t2[k]))
+            {
+              t[index[k]] = t2[k];
+              continue;
+            }
+          if (j != k)
+            {
+              index[j] = index[k];
+              t1[j] = t1[k];
+              t2[j] = t2[k];
+              bracket[j] = bracket[k];
+              for (i = 0; i < nc; ++i)
+                a[i][j] = a[i][k];
+            }
+          ++j;
+        }
+    }
+  equation_horizontal_batch (eq, x, c, t, n, y, w);
+  equation_vertical_batch (eq, c, t, n, y + 2 * n, y + 5 * n, w);
+  g_free (index);
+  g_free (w);
 #if DEBUG_EQUATION
-  fprintf (stderr, "equation_init: end\n");
+  fprintf (stderr, "equation_solve_batch: end\n");
 #endif
 }
 
@@ -968,6 +1196,8 @@ equation_read_xml (Equation * eq,       ///< Equation struct.
 					e = 14;
 					goto exit_on_error;
 				}
+      eq->vertical_sin = sinl (eq->vertical_angle * M_PIl / 180.L);
+      eq->vertical_cos = cosl (eq->vertical_angle * M_PIl / 180.L);
       eq->max_wind 
 				= xml_node_get_float_with_default (node, XML_WMAX, 0.L, &error_code);
 			if (error_code || eq->max_wind < 0.L)
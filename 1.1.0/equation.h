@@ -48,7 +48,15 @@ typedef struct
   long double g;                ///< vertical acceleration constant.
   long double tf;               ///< final time.
   long double lambda;           ///< friction coefficient.
+  long double li;               ///< inverse of the friction coefficient.
+  long double gl;               ///< square root of g by lambda.
+  long double g_l;              ///< square root of g divided by lambda.
+  long double alpha;            ///< arctangent of the vertical velocity by g_l.
+  long double tc;               ///< time to reach the maximum height.
+  long double calpha;           ///< cosine of alpha.
   long double vertical_angle;   ///< initial vertical angle.
+  long double vertical_sin;     ///< sine of the initial vertical angle.
+  long double vertical_cos;     ///< cosine of the initial vertical angle.
   long double max_lambda;       ///< maximum friction coefficient.
   long double min_lambda;       ///< minimum friction coefficient.
   long double max_velocity;     ///< maximum projectil velocity.
@@ -59,12 +67,12 @@ typedef struct
   unsigned int size_type;       ///< time step size type.
 } Equation;
 
-extern long double r0[3];
-extern long double r1[3];
-extern long double r2[3];
-extern long double ro0[3];
-extern long double ro1[3];
-extern long double ro2[3];
+extern _Thread_local long double r0[3];
+extern _Thread_local long double r1[3];
+extern _Thread_local long double r2[3];
+extern _Thread_local long double ro0[3];
+extern _Thread_local long double ro1[3];
+extern _Thread_local long double ro2[3];
 extern void (*equation_acceleration) (Equation * eq, long double *r0,
                                       long double *r1, long double *r2,
                                       long double t);
@@ -75,10 +83,19 @@ extern int (*equation_land) (Equation * eq, long double, long double *t,
                              long double *dt);
 extern long double kt;
 extern long double dt;
-extern unsigned long int nevaluations;
+extern _Thread_local unsigned long int nevaluations;
 
 long double equation_solve (Equation * eq, long double *r0, long double *r1);
-void equation_init (Equation * eq, gsl_rng * rng);
+long double equation_surrogate (Equation * eq, unsigned int type,
+                                long double *r0, long double *r1);
+void equation_invariants (Equation * eq);
+void equation_init (Equation * eq, const double *u);
+void equation_init_batch (Equation * eq, const double *u, unsigned int n,
+                          double *x);
+void equation_solution_batch (Equation * eq, const double *x, const double *t,
+                              unsigned int n, double *y);
+void equation_solve_batch (Equation * eq, const double *x, unsigned int n,
+                           double *t, double *y);
 int equation_read_xml (Equation * eq, xmlNode * node, unsigned int initial);
 
 #endif
@@ -0,0 +1,297 @@
+/*
+Ballistic: a software to benchmark ballistic models.
+
+AUTHORS: Javier Burguete Tolosa.
+
+Copyright 2018, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+/**
+ * \file level.c
+ * \brief Source file to define the convergence level results functions.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2018.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "config.h"
+#include "statistics.h"
+#include "level.h"
+
+#define DEBUG_LEVEL 0           ///< macro to debug the level functions.
+
+/**
+ * Function to init the results of a convergence level.
+ */
+void
+level_init (Level * l,          ///< Level struct.
+            long double kt,     ///< time step size factor.
+            long double emt,    ///< maximum error per time.
+            long double f,      ///< factor from the previous level.
+            unsigned int max_costs)
+  ///< maximum number of most expensive trajectories (0: no trajectory costs).
+{
+  histogram_init (&l->hsteps);
+  histogram_init (&l->hevaluations);
+  histogram_init (&l->htime);
+  l->ncosts = 0;
+  l->max_costs = max_costs;
+  statistics_init (&l->sr0s);
+  statistics_init (&l->sr1s);
+  statistics_init (&l->sr0q);
+  sketch_init (&l->sr0k);
+  l->kt = kt;
+  l->emt = emt;
+  l->f = f;
+  l->time = l->cpu_time = 0.L;
+  l->nevaluations = l->naccepted = l->nrejected = 0l;
+}
+
+/**
+ * Function to insert a trajectory on the most expensive trajectories of a
+ *   convergence level.
+ */
+static inline void
+level_insert_cost (Level * l,   ///< Level struct.
+                   const LevelCost * c) ///< LevelCost struct.
+{
+  unsigned int i;
+  i = l->ncosts;
+  if (i == l->max_costs)
+    {
+      if (!i || c->time <= l->cost[i - 1].time)
+        return;
+      --i;
+    }
+  else
+    ++l->ncosts;
+  for (; i > 0 && l->cost[i - 1].time < c->time; --i)
+    l->cost[i] = l->cost[i - 1];
+  l->cost[i] = *c;
+}
+
+/**
+ * Function to add the errors of a trajectory to the results of a convergence
+ *   level.
+ */
+CPU_DISPATCH void
+level_add (Level * l,           ///< Level struct.
+           long double e0,      ///< position error.
+           long double e1)      ///< velocity error.
+{
+  statistics_add (&l->sr0s, e0);
+  sketch_add (&l->sr0k, e0);
+  statistics_add (&l->sr1s, e1);
+  statistics_add (&l->sr0q, e0 * e0);
+}
+
+/**
+ * Function to add the cost of a trajectory to the results of a convergence
+ *   level.
+ */
+void
+level_cost (Level * l,          ///< Level struct.
+            unsigned int index, ///< trajectory index.
+            unsigned long int nsteps,   ///< number of steps.
+            unsigned long int nevaluations,     ///< number of evaluations.
+            unsigned long long int time)
+  ///< calculation time in nanoseconds.
+{
+  LevelCost c[1];
+  histogram_add (&l->hsteps, nsteps);
+  histogram_add (&l->hevaluations, nevaluations);
+  histogram_add (&l->htime, time);
+  c->time = time;
+  c->nsteps = nsteps;
+  c->nevaluations = nevaluations;
+  c->index = index;
+  level_insert_cost (l, c);
+}
+
+/**
+ * Function to merge the results of a convergence level.
+ */
+void
+level_merge (Level * l,         ///< Level struct.
+             const Level * l2)  ///< Level struct to add.
+{
+  unsigned int i;
+  statistics_merge (&l->sr0s, &l2->sr0s);
+  statistics_merge (&l->sr1s, &l2->sr1s);
+  statistics_merge (&l->sr0q, &l2->sr0q);
+  sketch_merge (&l->sr0k, &l2->sr0k);
+  l->time = fmaxl (l->time, l2->time);
+  l->cpu_time += l2->cpu_time;
+  l->nevaluations += l2->nevaluations;
+  l->naccepted += l2->naccepted;
+  l->nrejected += l2->nrejected;
+  histogram_merge (&l->hsteps, &l2->hsteps);
+  histogram_merge (&l->hevaluations, &l2->hevaluations);
+  histogram_merge (&l->htime, &l2->htime);
+  for (i = 0; i < l2->ncosts; ++i)
+    level_insert_cost (l, l2->cost + i);
+}
+
+/**
+ * Function to estimate the observed order of convergence from the previous
+ *   level.
+ *
+ * \return observed order, 0 if it can not be estimated.
+ */
+long double
+level_order (Level * l,         ///< Level struct.
+             long double e0)    ///< RMS position error of the previous level.
+{
+  long double e1;
+  e1 = statistics_rms (&l->sr0s);
+  if (e0 <= 0.L || e1 <= 0.L || l->f == 1.L)
+    return 0.L;
+  return logl (e1 / e0) / logl (l->f);
+}
+
+/**
+ * Function to print the results of a convergence level on a line of the
+ *   results file.
+ *
+ * The last columns are the wall time, the CPU time, the numbers of accepted and
+ * rejected steps and the trajectories per second, for work-precision diagrams.
+ *
+ * \return RMS position error.
+ */
+long double
+level_print (Level * l,         ///< Level struct.
+             FILE * file,       ///< results file.
+             long double e0,    ///< RMS position error of the previous level.
+             long double *order)        ///< pointer to the observed order.
+{
+  long double e, throughput;
+  e = statistics_rms (&l->sr0s);
+  *order = level_order (l, e0);
+  throughput = (l->time > 0.L) ? l->sr0s.n / l->time : 0.L;
+  fprintf (file, "%lu %.19Le %.19Le %.19Le %.19Le %.19Le %.19Le"
+           " %.19Le %.19Le %.19Le %lu %.19Le %.19Le %.19Le %lu %lu %.19Le\n",
+           l->nevaluations, l->sr0s.max, e, l->sr1s.max,
+           statistics_rms (&l->sr1s), l->kt, l->emt,
+           sketch_quantile (&l->sr0k, 0.5L), sketch_quantile (&l->sr0k, 0.95L),
+           sketch_quantile (&l->sr0k, 0.99L), l->sr0s.n, *order, l->time,
+           l->cpu_time, l->naccepted, l->nrejected, throughput);
+  return e;
+}
+
+/**
+ * Function to print a histogram of the trajectory costs of a convergence level
+ *   on a data block of the costs file.
+ */
+static inline void
+level_print_histogram (Histogram * h,   ///< Histogram struct.
+                       FILE * file,     ///< costs file.
+                       unsigned int level,      ///< level number.
+                       const char *label)       ///< histogram label.
+{
+  unsigned long long int upper;
+  unsigned int i;
+  fprintf (file, "# level %u %s: lower upper count\n", level, label);
+  for (i = 0; i < HISTOGRAM_BUCKETS; ++i)
+    if (h->bucket[i])
+      {
+        upper = (i < HISTOGRAM_BUCKETS - 1) ? histogram_lower (i + 1) - 1
+          : 0xffffffffffffffffull;
+        fprintf (file, "%llu %llu %lu\n", histogram_lower (i), upper,
+                 h->bucket[i]);
+      }
+  fprintf (file, "\n\n");
+}
+
+/**
+ * Function to print the trajectory costs of a convergence level on the costs
+ *   file.
+ *
+ * The histograms of the steps, evaluations and nanoseconds by trajectory and
+ * the most expensive trajectories are printed as data blocks separated by two
+ * blank lines, to be selected by index on gnuplot.
+ */
+void
+level_print_costs (Level * l,   ///< Level struct.
+                   FILE * file, ///< costs file.
+                   unsigned int level)  ///< level number.
+{
+  unsigned int i;
+  level_print_histogram (&l->hsteps, file, level, "steps");
+  level_print_histogram (&l->hevaluations, file, level, "evaluations");
+  level_print_histogram (&l->htime, file, level, "nanoseconds");
+  fprintf (file,
+           "# level %u most expensive: trajectory nanoseconds steps "
+           "evaluations\n", level);
+  for (i = 0; i < l->ncosts; ++i)
+    fprintf (file, "%u %llu %lu %lu\n", l->cost[i].index, l->cost[i].time,
+             l->cost[i].nsteps, l->cost[i].nevaluations);
+  fprintf (file, "\n\n");
+}
+
+/**
+ * Function to write the header of a shard file.
+ *
+ * A shard file has the SHARD_MAGIC identifier, the SHARD_VERSION format
+ * version, the size of the Level struct and the ShardHeader struct, followed by
+ * the Level structs. The structs are written raw, so the shards of other
+ * formats or builds are rejected.
+ *
+ * \return 1 on success, 0 on error.
+ */
+int
+shard_write_header (FILE * file,        ///< shard file.
+                    const ShardHeader * h)      ///< ShardHeader struct.
+{
+  unsigned int version[2];
+  version[0] = SHARD_VERSION;
+  version[1] = sizeof (Level);
+  return fwrite (SHARD_MAGIC, sizeof (SHARD_MAGIC), 1, file) == 1
+    && fwrite (version, sizeof (unsigned int), 2, file) == 2
+    && fwrite (h, sizeof (ShardHeader), 1, file) == 1;
+}
+
+/**
+ * Function to read the header of a shard file.
+ *
+ * \return 1 on success, 0 on error.
+ */
+int
+shard_read_header (FILE * file, ///< shard file.
+                   ShardHeader * h)     ///< ShardHeader struct.
+{
+  char magic[sizeof (SHARD_MAGIC)];
+  unsigned int version[2];
+  if (fread (magic, sizeof (SHARD_MAGIC), 1, file) != 1
+      || memcmp (magic, SHARD_MAGIC, sizeof (SHARD_MAGIC))
+      || fread (version, sizeof (unsigned int), 2, file) != 2
+      || version[0] != SHARD_VERSION || version[1] != sizeof (Level)
+      || fread (h, sizeof (ShardHeader), 1, file) != 1)
+    return 0;
+#if DEBUG_LEVEL
+  fprintf (stderr, "shard_read_header: nlevels=%u\n", h->nlevels);
+#endif
+  return 1;
+}
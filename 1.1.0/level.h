@@ -0,0 +1,124 @@
+/*
+Ballistic: a software to benchmark ballistic models.
+
+AUTHORS: Javier Burguete Tolosa.
+
+Copyright 2018, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+/**
+ * \file level.h
+ * \brief Header file to define the convergence level results data and
+ *   functions.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2018.
+ */
+#ifndef LEVEL__H
+#define LEVEL__H 1
+
+#define SHARD_MAGIC "ballistic-shard"   ///< shard file identifier.
+#define SHARD_VERSION 3
+///< shard file format version (increase it on changing the header or Level).
+#define LEVEL_COSTS 64
+///< maximum number of the most expensive trajectories of a level.
+
+/**
+ * \struct LevelCost
+ * \brief struct to define the cost of a trajectory.
+ */
+typedef struct
+{
+  unsigned long long int time;  ///< calculation time in nanoseconds.
+  unsigned long int nsteps;     ///< number of steps.
+  unsigned long int nevaluations;       ///< number of evaluations.
+  unsigned int index;           ///< trajectory index.
+} LevelCost;
+
+/**
+ * \struct ShardHeader
+ * \brief struct to define the header of a shard file.
+ *
+ * The sampling data identify the trajectories of the shard, so the shards of
+ * different samples or with overlapping trajectories are not merged.
+ */
+typedef struct
+{
+  long double min_order;        ///< minimum observed order.
+  long double target_error;     ///< target error.
+  unsigned int nlevels;         ///< number of levels.
+  unsigned int type;            ///< sampling type.
+  unsigned int seed;            ///< pseudo-random numbers seed.
+  unsigned int scramble;        ///< scramble seed.
+  unsigned int offset;          ///< index of the first trajectory.
+  unsigned int ntrajectories;   ///< number of trajectories.
+} ShardHeader;
+
+/**
+ * \struct Level
+ * \brief struct to define the partial results of a convergence level.
+ *
+ * The results are mergeable accumulators, so the results of a level calculated
+ * by several processes on disjoint trajectories are merged exactly. The
+ * processes run concurrently, so the wall time is the maximum one and the CPU
+ * times are summed. With trajectory costs, the steps, evaluations and time of
+ * every trajectory are counted on histograms and the most expensive
+ * trajectories (by time) are kept ordered by decreasing time.
+ */
+typedef struct
+{
+  Histogram hsteps;             ///< steps by trajectory histogram.
+  Histogram hevaluations;       ///< evaluations by trajectory histogram.
+  Histogram htime;              ///< nanoseconds by trajectory histogram.
+  LevelCost cost[LEVEL_COSTS];  ///< most expensive trajectories.
+  Statistics sr0s;              ///< position errors statistics.
+  Statistics sr1s;              ///< velocity errors statistics.
+  Statistics sr0q;              ///< squared position errors statistics.
+  Sketch sr0k;                  ///< position errors quantiles sketch.
+  long double kt;               ///< time step size factor.
+  long double emt;              ///< maximum error per time.
+  long double f;                ///< factor from the previous level.
+  long double time;             ///< wall time.
+  long double cpu_time;         ///< CPU time of all the threads.
+  unsigned long int nevaluations;       ///< number of evaluations.
+  unsigned long int naccepted;  ///< number of accepted steps.
+  unsigned long int nrejected;  ///< number of rejected steps.
+  unsigned int ncosts;          ///< number of most expensive trajectories.
+  unsigned int max_costs;
+  ///< maximum number of most expensive trajectories (0: no trajectory costs).
+} Level;
+
+void level_init (Level * l, long double kt, long double emt, long double f,
+                 unsigned int max_costs);
+void level_add (Level * l, long double e0, long double e1);
+void level_cost (Level * l, unsigned int index, unsigned long int nsteps,
+                 unsigned long int nevaluations, unsigned long long int time);
+void level_merge (Level * l, const Level * l2);
+long double level_order (Level * l, long double e0);
+long double level_print (Level * l, FILE * file, long double e0,
+                         long double *order);
+void level_print_costs (Level * l, FILE * file, unsigned int level);
+int shard_write_header (FILE * file, const ShardHeader * h);
+int shard_read_header (FILE * file, ShardHeader * h);
+
+#endif
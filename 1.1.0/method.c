@@ -49,6 +49,11 @@ OF SUCH DAMAGE.
 #define DEBUG_METHOD 0
 ///< macro to debug the numerical method functions.
 
+_Thread_local unsigned long int naccepted;
+///< number of accepted steps on the thread.
+_Thread_local unsigned long int nrejected;
+///< number of rejected steps on the thread.
+
 /**
  * Function to init the numerical method.
  */
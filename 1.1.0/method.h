@@ -57,6 +57,9 @@ typedef struct
   unsigned int error_dt;        ///< type of error time step size control. 
 } Method;
 
+extern _Thread_local unsigned long int naccepted;
+extern _Thread_local unsigned long int nrejected;
+
 void method_init (Method * m, unsigned int nsteps, unsigned int order);
 void method_init_variables (Method * m);
 long double method_dt (Method * m, long double dt);
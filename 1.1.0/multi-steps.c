@@ -43,6 +43,7 @@ OF SUCH DAMAGE.
 #include "config.h"
 #include "utils.h"
 #include "equation.h"
+#include "equation-inline.h"
 #include "method.h"
 #include "runge-kutta.h"
 #include "multi-steps.h"
@@ -137,11 +138,15 @@ multi_steps_init_variables (MultiSteps * ms)
 /**
  * Function to perform a step of the multi-steps method.
  */
-static inline void
+static inline __attribute__ ((always_inline)) void
 multi_steps_step (MultiSteps * ms,      ///< MultiSteps struct.
                   Equation * eq,        ///< Equation struct.
                   long double t,        ///< actual time.
-                  long double dt)       ///< time step size.
+                  long double dt,       ///< time step size.
+                  void (*acceleration) (Equation *, long double *,
+                                        long double *, long double *,
+                                        long double))
+  ///< acceleration function.
 {
   long double msr0[3], msr1[3];
   Method *m;
@@ -212,7 +217,7 @@ multi_steps_step (MultiSteps * ms,      ///< MultiSteps struct.
     }
   memcpy (r0, msr0, 3 * sizeof (long double));
   memcpy (r1, msr1, 3 * sizeof (long double));
-  equation_acceleration (eq, r0, r1, r2, t + dt);
+  acceleration (eq, r0, r1, r2, t + dt);
 #if DEBUG_MULTI_STEPS
   for (i = 0; i < 3; ++i)
     fprintf (stderr, "multi_steps_step: r0[0][%u]=%Lg\n", i, r0[i]);
@@ -258,13 +263,31 @@ multi_steps_error (MultiSteps * ms,     ///< MultiSteps struct.
 }
 
 /**
- * Function to run the multi-steps method bucle.
+ * Function to run the multi-steps method bucle with the equation functions.
+ *
+ * It is always inlined, so with constant equation functions and error control
+ * type the bucle has not indirect calls and the equation functions are
+ * inlined.
  *
  * \return final time. 
  */
-long double
-multi_steps_run (MultiSteps * ms,       ///< MultiSteps struct.
-                 Equation * eq) ///< Equation struct.
+static inline __attribute__ ((always_inline)) long double
+multi_steps_run_kernel (MultiSteps * ms,        ///< MultiSteps struct.
+                        Equation * eq,  ///< Equation struct.
+                        void (*acceleration) (Equation *, long double *,
+                                              long double *, long double *,
+                                              long double),
+                        ///< acceleration function.
+                        void (*rk_step) (RungeKutta *, Equation *,
+                                         long double, long double),
+                        ///< Runge-Kutta step function.
+                        long double (*step_size) (Equation *),
+                        ///< time step size function.
+                        int (*land) (Equation *, long double, long double *,
+                                     long double *),
+                        ///< landing function.
+                        unsigned int error_dt)
+  ///< type of error time step size control.
 {
   RungeKutta *rk;
   Method *m, *mrk;
@@ -298,6 +321,8 @@ multi_steps_run (MultiSteps * ms,       ///< MultiSteps struct.
           if (dt < mrk->beta * dto)
             {
               ++i;
+              --naccepted;
+              ++nrejected;
               t = to;
               mrk->et0 = et0o;
               mrk->et1 = et1o;
@@ -307,11 +332,11 @@ multi_steps_run (MultiSteps * ms,       ///< MultiSteps struct.
             }
         }
       else
-        dt = equation_step_size (eq);
+        dt = step_size (eq);
 
       // checking trajectory end
       to = t;
-      if (equation_land (eq, to, &t, &dt))
+      if (land (eq, to, &t, &dt))
         goto end;
 #if DEBUG_MULTI_STEPS
       fprintf (stderr, "multi_steps_run: t=%Lg dt=%Lg\n", t, dt);
@@ -326,7 +351,8 @@ multi_steps_run (MultiSteps * ms,       ///< MultiSteps struct.
       memcpy (ro2, r2, 3 * sizeof (long double));
 
       // Runge-Kutta step
-      runge_kutta_step (rk, eq, to, dt);
+      rk_step (rk, eq, to, dt);
+      ++naccepted;
 
       // error estimate
       if (mrk->error_dt)
@@ -351,7 +377,7 @@ multi_steps_run (MultiSteps * ms,       ///< MultiSteps struct.
     {
 
       // time step size
-      if (m->error_dt)
+      if (error_dt)
         {
           dto = dt;
           dt = method_dt (m, dt);
@@ -360,6 +386,8 @@ multi_steps_run (MultiSteps * ms,       ///< MultiSteps struct.
           if (dt < mrk->beta * dto)
             {
               ++i;
+              --naccepted;
+              ++nrejected;
               t = to;
               m->et0 = et0o;
               m->et1 = et1o;
@@ -369,12 +397,12 @@ multi_steps_run (MultiSteps * ms,       ///< MultiSteps struct.
             }
         }
       else
-        dt = equation_step_size (eq);
+        dt = step_size (eq);
 
       // checking trajectory end
       to = t;
       dto = dt;
-      if (equation_land (eq, to, &t, &dt))
+      if (land (eq, to, &t, &dt))
         break;
 #if DEBUG_MULTI_STEPS
       fprintf (stderr, "multi_steps_run: t=%Lg dt=%Lg\n", t, dt);
@@ -387,12 +415,13 @@ multi_steps_run (MultiSteps * ms,       ///< MultiSteps struct.
 
       // multi-steps step
       if (dto == dt)
-        multi_steps_step (ms, eq, to, dt);
+        multi_steps_step (ms, eq, to, dt, acceleration);
       else
-        runge_kutta_step (rk, eq, to, dt);
+        rk_step (rk, eq, to, dt);
+      ++naccepted;
 
       // error estimate
-      if (m->error_dt)
+      if (error_dt)
         {
           et0o = m->et0;
           et1o = m->et1;
@@ -406,6 +435,74 @@ end:
   return t;
 }
 
+/**
+ * Function to run the multi-steps method bucle with the equation function
+ *   pointers.
+ *
+ * \return final time.
+ */
+static CPU_DISPATCH long double
+multi_steps_run_generic (MultiSteps * ms,       ///< MultiSteps struct.
+                         Equation * eq) ///< Equation struct.
+{
+  return multi_steps_run_kernel (ms, eq, equation_acceleration,
+                                 runge_kutta_step, equation_step_size,
+                                 equation_land,
+                                 MULTI_STEPS_METHOD (ms)->error_dt);
+}
+
+/**
+ * Macro to define a multi-steps method bucle specialized on an equation type,
+ *   a landing type, a time step size function and an error control type.
+ */
+#define MULTI_STEPS_RUN(type, land, size, error) \
+static CPU_DISPATCH long double \
+multi_steps_run_##type##_##land##_##size##_##error (MultiSteps * ms, \
+                                                    Equation * eq) \
+{ \
+  return multi_steps_run_kernel (ms, eq, equation_acceleration_##type, \
+                                 runge_kutta_step_##type, \
+                                 equation_step_size_##size, \
+                                 equation_land_##land, error); \
+}
+
+EQUATION_SPECIALIZE (MULTI_STEPS_RUN)
+
+/**
+ * Macro to define an element of the array of specialized multi-steps method
+ *   bucles.
+ */
+#define MULTI_STEPS_RUN_ELEMENT(type, land, size, error) \
+  [type][size][land][error] = multi_steps_run_##type##_##land##_##size##_##error,
+
+///> array of specialized multi-steps method bucles.
+static long double (*const multi_steps_run_specialized[4][4][4][2])
+  (MultiSteps * ms, Equation * eq) =
+{
+EQUATION_SPECIALIZE (MULTI_STEPS_RUN_ELEMENT)
+};
+
+/**
+ * Function to run the multi-steps method bucle.
+ *
+ * The bucle specialized on the equation data is selected by a single indirect
+ * call by trajectory. The not specialized combinations run with the equation
+ * function pointers.
+ *
+ * \return final time. 
+ */
+long double
+multi_steps_run (MultiSteps * ms,       ///< MultiSteps struct.
+                 Equation * eq) ///< Equation struct.
+{
+  long double (*run) (MultiSteps *, Equation *);
+  run = multi_steps_run_specialized[eq->type][equation_step_size_type (eq)]
+    [eq->land_type][MULTI_STEPS_METHOD (ms)->error_dt];
+  if (!run)
+    run = multi_steps_run_generic;
+  return run (ms, eq);
+}
+
 /**
  * Function to free the memory used by a MultiSteps struct.
  */
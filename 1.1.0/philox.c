@@ -0,0 +1,204 @@
+/*
+Ballistic: a software to benchmark ballistic models.
+
+AUTHORS: Javier Burguete Tolosa.
+
+Copyright 2018, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+/**
+ * \file philox.c
+ * \brief Source file to define the counter-based random numbers generator.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2018.
+ *
+ * The generator is the Philox4x32-10 algorithm of J. K. Salmon, M. A. Moraes,
+ * R. O. Dror and D. E. Shaw, "Parallel random numbers: as easy as 1, 2, 3",
+ * SC'11 (2011). The random numbers are a function of a counter and a key
+ * without any internal state, so any number of the sequence can be generated
+ * in any order.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdint.h>
+#include "config.h"
+#include "philox.h"
+
+#define DEBUG_PHILOX 0          ///< macro to debug the Philox functions.
+
+#define PHILOX_M0 0xD2511F53u   ///< 1st Philox multiplier.
+#define PHILOX_M1 0xCD9E8D57u   ///< 2nd Philox multiplier.
+#define PHILOX_W0 0x9E3779B9u   ///< 1st Philox key increment.
+#define PHILOX_W1 0xBB67AE85u   ///< 2nd Philox key increment.
+#define PHILOX_ROUNDS 10        ///< number of Philox rounds.
+#define PHILOX_BATCH 256        ///< number of sequences of a batch block.
+
+/**
+ * Function to calculate a block of 4 random 32 bits words with the
+ *   Philox4x32-10 algorithm.
+ */
+void
+philox_4x32 (const uint32_t * counter,  ///< array of 4 counter words.
+             const uint32_t * key,      ///< array of 2 key words.
+             uint32_t * x)      ///< array of 4 random words.
+{
+  uint64_t p0, p1;
+  uint32_t k0, k1, x0, x1, x2, x3;
+  unsigned int i;
+  x0 = counter[0];
+  x1 = counter[1];
+  x2 = counter[2];
+  x3 = counter[3];
+  k0 = key[0];
+  k1 = key[1];
+  for (i = 0; i < PHILOX_ROUNDS; ++i)
+    {
+      p0 = (uint64_t) PHILOX_M0 *x0;
+      p1 = (uint64_t) PHILOX_M1 *x2;
+      x0 = (uint32_t) (p1 >> 32) ^ x1 ^ k0;
+      x1 = (uint32_t) p1;
+      x2 = (uint32_t) (p0 >> 32) ^ x3 ^ k1;
+      x3 = (uint32_t) p0;
+      k0 += PHILOX_W0;
+      k1 += PHILOX_W1;
+    }
+  x[0] = x0;
+  x[1] = x1;
+  x[2] = x2;
+  x[3] = x3;
+}
+
+/**
+ * Function to generate the uniform random numbers of a sequence index.
+ *
+ * The numbers only depend on the seed and on the index, so every sequence can
+ * be regenerated in O(1) independently of the order of generation. Every
+ * number uses two 32 bits words to get a 53 bits resolution in
+ * \f$[0,\;1)\f$.
+ */
+void
+philox_uniform (unsigned long int seed, ///< seed.
+                unsigned long int index,        ///< sequence index.
+                double *u,      ///< array of uniform random numbers.
+                unsigned int n) ///< number of random numbers.
+{
+  uint32_t counter[4], key[2], x[4];
+  unsigned int i;
+#if DEBUG_PHILOX
+  fprintf (stderr, "philox_uniform: start\n");
+  fprintf (stderr, "philox_uniform: seed=%lu index=%lu\n", seed, index);
+#endif
+  key[0] = (uint32_t) seed;
+  key[1] = (uint32_t) ((uint64_t) seed >> 32);
+  counter[0] = (uint32_t) index;
+  counter[1] = (uint32_t) ((uint64_t) index >> 32);
+  counter[3] = 0;
+  for (i = 0; i < n; ++i)
+    {
+      if (!(i & 1))
+        {
+          counter[2] = i >> 1;
+          philox_4x32 (counter, key, x);
+        }
+      u[i] = (double) ((((uint64_t) x[2 * (i & 1)] << 32)
+                        | x[2 * (i & 1) + 1]) >> 11) * 0x1p-53;
+    }
+#if DEBUG_PHILOX
+  fprintf (stderr, "philox_uniform: end\n");
+#endif
+}
+
+/**
+ * Function to generate the uniform random numbers of a batch of consecutive
+ *   sequence indices.
+ *
+ * The numbers are the same than the obtained by the philox_uniform function
+ * but the generator rounds are applied to blocks of sequences, so the inner
+ * loops have no dependencies and they can be vectorized. The numbers are
+ * stored by columns: u[j*n+i] is the j-th number of the sequence first+i.
+ */
+CPU_DISPATCH void
+philox_uniform_batch (unsigned long int seed,   ///< seed.
+                      unsigned long int first,  ///< first sequence index.
+                      unsigned int n,   ///< number of sequences.
+                      double *u,        ///< array of uniform random numbers.
+                      unsigned int m)   ///< number of numbers per sequence.
+{
+  uint32_t x0[PHILOX_BATCH], x1[PHILOX_BATCH], x2[PHILOX_BATCH],
+    x3[PHILOX_BATCH];
+  uint64_t p0, p1, index;
+  uint32_t k0, k1, y0, y1, y2, y3;
+  unsigned int i, j, k, l, nb;
+#if DEBUG_PHILOX
+  fprintf (stderr, "philox_uniform_batch: start\n");
+  fprintf (stderr, "philox_uniform_batch: seed=%lu first=%lu n=%u m=%u\n",
+           seed, first, n, m);
+#endif
+  for (i = 0; i < n; i += PHILOX_BATCH)
+    {
+      nb = (n - i < PHILOX_BATCH) ? n - i : PHILOX_BATCH;
+      for (j = 0; j < m; j += 2)
+        {
+          for (l = 0; l < nb; ++l)
+            {
+              index = (uint64_t) first + i + l;
+              x0[l] = (uint32_t) index;
+              x1[l] = (uint32_t) (index >> 32);
+              x2[l] = j >> 1;
+              x3[l] = 0;
+            }
+          k0 = (uint32_t) seed;
+          k1 = (uint32_t) ((uint64_t) seed >> 32);
+          for (k = 0; k < PHILOX_ROUNDS; ++k)
+            {
+              for (l = 0; l < nb; ++l)
+                {
+                  p0 = (uint64_t) PHILOX_M0 *x0[l];
+                  p1 = (uint64_t) PHILOX_M1 *x2[l];
+                  y0 = (uint32_t) (p1 >> 32) ^ x1[l] ^ k0;
+                  y1 = (uint32_t) p1;
+                  y2 = (uint32_t) (p0 >> 32) ^ x3[l] ^ k1;
+                  y3 = (uint32_t) p0;
+                  x0[l] = y0;
+                  x1[l] = y1;
+                  x2[l] = y2;
+                  x3[l] = y3;
+                }
+              k0 += PHILOX_W0;
+              k1 += PHILOX_W1;
+            }
+          for (l = 0; l < nb; ++l)
+            u[j * (size_t) n + i + l]
+              = (double) ((((uint64_t) x0[l] << 32) | x1[l]) >> 11) * 0x1p-53;
+          if (j + 1 < m)
+            for (l = 0; l < nb; ++l)
+              u[(j + 1) * (size_t) n + i + l]
+                = (double) ((((uint64_t) x2[l] << 32) | x3[l]) >> 11)
+                * 0x1p-53;
+        }
+    }
+#if DEBUG_PHILOX
+  fprintf (stderr, "philox_uniform_batch: end\n");
+#endif
+}
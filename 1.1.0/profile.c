@@ -0,0 +1,342 @@
+/*
+Ballistic: a software to benchmark ballistic models.
+
+AUTHORS: Javier Burguete Tolosa.
+
+Copyright 2018, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+/**
+ * \file profile.c
+ * \brief Source file to define the run profile functions.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2018.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <glib.h>
+#include "profile.h"
+
+#define DEBUG_PROFILE 0         ///< macro to debug the profile functions.
+
+Profile profile[1];             ///< profile of the run.
+
+/**
+ * Function to init the profile of the run.
+ */
+void
+profile_init ()
+{
+  unsigned int i;
+  for (i = 0; i < PROFILE_PHASES; ++i)
+    profile->time[i] = 0ll;
+  for (i = 0; i < PROFILE_COUNTERS; ++i)
+    profile->fd[i] = -1;
+  profile->naccepted = profile->nrejected = profile->nevaluations = 0l;
+  profile->level = NULL;
+  profile->nlevels = profile->perf = 0;
+  profile->start = profile_clock ();
+}
+
+/**
+ * Function to read the monotonic clock.
+ *
+ * \return monotonic clock time in nanoseconds.
+ */
+unsigned long long int
+profile_clock ()
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (unsigned long long int) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/**
+ * Function to read the CPU time clock of the process.
+ *
+ * \return CPU time of all the threads of the process in nanoseconds.
+ */
+unsigned long long int
+profile_cpu_clock ()
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return (unsigned long long int) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/**
+ * Function to add a time to a phase of the profile.
+ *
+ * It is atomic, so it can be called from several threads.
+ */
+void
+profile_add (unsigned int phase,        ///< phase.
+             unsigned long long int time)       ///< time in nanoseconds.
+{
+  __atomic_add_fetch (profile->time + phase, time, __ATOMIC_RELAXED);
+}
+
+/**
+ * Function to open the hardware performance counters.
+ *
+ * The counters only count the user space of the main thread and of the threads
+ * that it creates. A counter denied by the kernel (i.e. on a container) is left
+ * unavailable.
+ *
+ * \return 1 if any counter is available, 0 otherwise.
+ */
+int
+profile_perf_open ()
+{
+  const unsigned long long int config[PROFILE_COUNTERS] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES
+  };
+  struct perf_event_attr attr;
+  unsigned int i;
+#if DEBUG_PROFILE
+  fprintf (stderr, "profile_perf_open: start\n");
+#endif
+  memset (&attr, 0, sizeof (struct perf_event_attr));
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.size = sizeof (struct perf_event_attr);
+  attr.disabled = 1;
+  attr.inherit = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED
+    | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  for (i = 0; i < PROFILE_COUNTERS; ++i)
+    {
+      attr.config = config[i];
+      profile->fd[i] = (int) syscall (SYS_perf_event_open, &attr, 0, -1, -1, 0);
+      if (profile->fd[i] >= 0)
+        profile->perf = 1;
+    }
+#if DEBUG_PROFILE
+  fprintf (stderr, "profile_perf_open: perf=%u\n", profile->perf);
+  fprintf (stderr, "profile_perf_open: end\n");
+#endif
+  return profile->perf;
+}
+
+/**
+ * Function to reset and to start the hardware performance counters.
+ */
+void
+profile_perf_start ()
+{
+  unsigned int i;
+  for (i = 0; i < PROFILE_COUNTERS; ++i)
+    if (profile->fd[i] >= 0)
+      {
+        ioctl (profile->fd[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl (profile->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+      }
+}
+
+/**
+ * Function to stop the hardware performance counters and to save their values
+ *   on a new level.
+ *
+ * The values are scaled by the enabled and running times, as the kernel
+ * multiplexes the counters when there are not enough hardware counters.
+ */
+void
+profile_perf_stop (unsigned long int nevaluations,
+                   ///< number of evaluations of the level.
+                   unsigned long int ntrajectories)
+  ///< number of trajectories of the level.
+{
+  ProfileLevel *l;
+  unsigned long long int value[3];
+  unsigned int i;
+  if (!profile->perf)
+    return;
+  profile->level = (ProfileLevel *)
+    g_realloc (profile->level, (profile->nlevels + 1) * sizeof (ProfileLevel));
+  l = profile->level + profile->nlevels++;
+  l->nevaluations = nevaluations;
+  l->ntrajectories = ntrajectories;
+  for (i = 0; i < PROFILE_COUNTERS; ++i)
+    {
+      l->count[i] = PROFILE_UNKNOWN;
+      if (profile->fd[i] < 0)
+        continue;
+      ioctl (profile->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+      if (read (profile->fd[i], value, sizeof (value)) == sizeof (value)
+          && value[2])
+        l->count[i] = (unsigned long long int)
+          ((long double) value[0] * value[1] / value[2]);
+    }
+}
+
+/**
+ * Function to close the hardware performance counters and to free the memory
+ *   of the profile.
+ */
+void
+profile_delete ()
+{
+  unsigned int i;
+  for (i = 0; i < PROFILE_COUNTERS; ++i)
+    if (profile->fd[i] >= 0)
+      {
+        close (profile->fd[i]);
+        profile->fd[i] = -1;
+      }
+  g_free (profile->level);
+  profile->level = NULL;
+  profile->nlevels = profile->perf = 0;
+}
+
+/**
+ * Function to write a counter on a JSON file.
+ */
+static void
+profile_write_count (FILE * file,       ///< JSON file.
+                     const char *label, ///< counter label.
+                     unsigned long long int x)  ///< counter value.
+{
+  if (x == PROFILE_UNKNOWN)
+    fprintf (file, "      \"%s\": null,\n", label);
+  else
+    fprintf (file, "      \"%s\": %llu,\n", label, x);
+}
+
+/**
+ * Function to write a ratio of counters on a JSON file.
+ */
+static void
+profile_write_ratio (FILE * file,       ///< JSON file.
+                     const char *label, ///< ratio label.
+                     unsigned long long int x,  ///< numerator.
+                     unsigned long long int y,  ///< denominator.
+                     const char *end)   ///< end of the line.
+{
+  if (x == PROFILE_UNKNOWN || y == PROFILE_UNKNOWN || !y)
+    fprintf (file, "      \"%s\": null%s\n", label, end);
+  else
+    fprintf (file, "      \"%s\": %.6g%s\n", label, (double) x / y, end);
+}
+
+/**
+ * Function to write the hardware performance counters of the levels on a JSON
+ *   file.
+ */
+static void
+profile_write_perf (FILE * file)        ///< JSON file.
+{
+  ProfileLevel *l;
+  unsigned int i;
+  fprintf (file, "  \"perf\": [\n");
+  for (i = 0; i < profile->nlevels; ++i)
+    {
+      l = profile->level + i;
+      fprintf (file, "    {\n      \"level\": %u,\n", i);
+      profile_write_count (file, "cycles", l->count[PROFILE_CYCLES]);
+      profile_write_count (file, "instructions",
+                           l->count[PROFILE_INSTRUCTIONS]);
+      profile_write_count (file, "branch_misses",
+                           l->count[PROFILE_BRANCH_MISSES]);
+      profile_write_count (file, "cache_misses",
+                           l->count[PROFILE_CACHE_MISSES]);
+      profile_write_ratio (file, "ipc", l->count[PROFILE_INSTRUCTIONS],
+                           l->count[PROFILE_CYCLES], ",");
+      profile_write_ratio (file, "cycles_per_evaluation",
+                           l->count[PROFILE_CYCLES], l->nevaluations, ",");
+      profile_write_ratio (file, "instructions_per_evaluation",
+                           l->count[PROFILE_INSTRUCTIONS], l->nevaluations,
+                           ",");
+      profile_write_ratio (file, "cycles_per_trajectory",
+                           l->count[PROFILE_CYCLES], l->ntrajectories, ",");
+      profile_write_ratio (file, "instructions_per_trajectory",
+                           l->count[PROFILE_INSTRUCTIONS], l->ntrajectories,
+                           ",");
+      profile_write_ratio (file, "branch_misses_per_trajectory",
+                           l->count[PROFILE_BRANCH_MISSES], l->ntrajectories,
+                           ",");
+      profile_write_ratio (file, "cache_misses_per_trajectory",
+                           l->count[PROFILE_CACHE_MISSES], l->ntrajectories,
+                           "");
+      fprintf (file, "    }%s\n", (i < profile->nlevels - 1) ? "," : "");
+    }
+  fprintf (file, "  ],\n");
+}
+
+/**
+ * Function to write the profile of the run on a JSON file.
+ *
+ * \return 1 on success, 0 on error.
+ */
+int
+profile_write (const char *name,        ///< file name.
+               const char *method,      ///< numerical method name.
+               unsigned int order,      ///< numerical method order.
+               unsigned int ntrajectories,      ///< number of trajectories.
+               unsigned int nlevels)    ///< number of calculated levels.
+{
+  const char *label[PROFILE_PHASES] = {
+    "parse", "sample", "integration", "reference", "reduction", "output"
+  };
+  struct rusage usage;
+  FILE *file;
+  unsigned long long int total;
+  unsigned int i;
+#if DEBUG_PROFILE
+  fprintf (stderr, "profile_write: start\n");
+#endif
+  total = profile_clock () - profile->start;
+  file = fopen (name, "w");
+  if (!file)
+    return 0;
+  fprintf (file, "{\n  \"phases\": {\n");
+  for (i = 0; i < PROFILE_PHASES; ++i)
+    fprintf (file, "    \"%s\": %.9f%s\n", label[i], 1e-9 * profile->time[i],
+             (i < PROFILE_PHASES - 1) ? "," : "");
+  fprintf (file, "  },\n  \"total\": %.9f,\n", 1e-9 * total);
+  fprintf (file, "  \"method\": {\n    \"name\": \"%s\",\n    \"order\": %u,\n"
+           "    \"steps\": %lu,\n    \"rejected\": %lu,\n"
+           "    \"evaluations\": %lu\n  },\n",
+           method, order, profile->naccepted + profile->nrejected,
+           profile->nrejected, profile->nevaluations);
+  fprintf (file, "  \"trajectories\": %u,\n  \"levels\": %u,\n",
+           ntrajectories, nlevels);
+  if (profile->perf)
+    profile_write_perf (file);
+  getrusage (RUSAGE_SELF, &usage);
+  fprintf (file, "  \"max_rss_kib\": %ld\n}\n", usage.ru_maxrss);
+  fclose (file);
+#if DEBUG_PROFILE
+  fprintf (stderr, "profile_write: end\n");
+#endif
+  return 1;
+}
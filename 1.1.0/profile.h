@@ -0,0 +1,108 @@
+/*
+Ballistic: a software to benchmark ballistic models.
+
+AUTHORS: Javier Burguete Tolosa.
+
+Copyright 2018, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+/**
+ * \file profile.h
+ * \brief Header file to define the run profile data and functions.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2018.
+ */
+#ifndef PROFILE__H
+#define PROFILE__H 1
+
+#define PROFILE_PARSE 0         ///< XML parsing phase.
+#define PROFILE_SAMPLE 1        ///< sampling phase.
+#define PROFILE_INTEGRATION 2   ///< numerical integration phase.
+#define PROFILE_REFERENCE 3     ///< reference solutions phase.
+#define PROFILE_REDUCTION 4     ///< partial results reduction phase.
+#define PROFILE_OUTPUT 5        ///< results output phase.
+#define PROFILE_PHASES 6        ///< number of phases.
+
+#define PROFILE_CYCLES 0        ///< CPU cycles counter.
+#define PROFILE_INSTRUCTIONS 1  ///< instructions counter.
+#define PROFILE_BRANCH_MISSES 2 ///< branch misses counter.
+#define PROFILE_CACHE_MISSES 3  ///< cache misses counter.
+#define PROFILE_COUNTERS 4      ///< number of hardware performance counters.
+#define PROFILE_UNKNOWN 0xffffffffffffffffull
+///< value of an unavailable hardware performance counter.
+
+/**
+ * \struct ProfileLevel
+ * \brief struct to define the hardware performance counters of a level.
+ */
+typedef struct
+{
+  unsigned long long int count[PROFILE_COUNTERS];      ///< counter values.
+  unsigned long int nevaluations;       ///< number of evaluations.
+  unsigned long int ntrajectories;      ///< number of trajectories.
+} ProfileLevel;
+
+/**
+ * \struct Profile
+ * \brief struct to define the profile of a run.
+ *
+ * The phase times are monotonic clock times in nanoseconds of the main thread,
+ * except the reference solutions time, which is summed over the threads
+ * calculating them. On a pipeline the stages overlap, so the integration time
+ * of the first level includes the sampling and the reference solutions.
+ *
+ * The optional hardware performance counters of a level count the threads
+ * created by the main thread while the level is calculated, so they include
+ * the reference solution threads of a pipeline.
+ */
+typedef struct
+{
+  ProfileLevel *level;
+  ///< array of hardware performance counters of the levels.
+  unsigned long long int time[PROFILE_PHASES]; ///< phase times.
+  unsigned long long int start; ///< start time.
+  unsigned long int naccepted;  ///< number of accepted steps.
+  unsigned long int nrejected;  ///< number of rejected steps.
+  unsigned long int nevaluations;       ///< number of evaluations.
+  int fd[PROFILE_COUNTERS];     ///< hardware performance counters files.
+  unsigned int nlevels;
+  ///< number of levels with hardware performance counters.
+  unsigned int perf;            ///< 1 on hardware performance counters.
+} Profile;
+
+extern Profile profile[1];
+
+void profile_init ();
+unsigned long long int profile_clock ();
+unsigned long long int profile_cpu_clock ();
+void profile_add (unsigned int phase, unsigned long long int time);
+int profile_perf_open ();
+void profile_perf_start ();
+void profile_perf_stop (unsigned long int nevaluations,
+                        unsigned long int ntrajectories);
+void profile_delete ();
+int profile_write (const char *name, const char *method, unsigned int order,
+                   unsigned int ntrajectories, unsigned int nlevels);
+
+#endif
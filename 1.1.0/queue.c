@@ -0,0 +1,132 @@
+/*
+Ballistic: a software to benchmark ballistic models.
+
+AUTHORS: Javier Burguete Tolosa.
+
+Copyright 2018, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+/**
+ * \file queue.c
+ * \brief Source file to define the lock-free bounded queue functions.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2018.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <glib.h>
+#include "queue.h"
+
+#define DEBUG_QUEUE 0           ///< macro to debug the queue functions.
+
+/**
+ * Function to init a lock-free bounded queue.
+ */
+void
+queue_init (Queue * q)          ///< Queue struct.
+{
+  unsigned int i;
+  for (i = 0; i < QUEUE_SIZE; ++i)
+    q->cell[i].sequence = i;
+  q->head = q->tail = 0l;
+}
+
+/**
+ * Function to write a value on a lock-free bounded queue.
+ *
+ * If the queue is full, the thread yields until a cell is free.
+ */
+void
+queue_push (Queue * q,          ///< Queue struct.
+            unsigned int value) ///< value.
+{
+  QueueCell *c;
+  unsigned long int pos, seq;
+  long int d;
+  pos = __atomic_load_n (&q->head, __ATOMIC_RELAXED);
+  for (;;)
+    {
+      c = q->cell + (pos & (QUEUE_SIZE - 1));
+      seq = __atomic_load_n (&c->sequence, __ATOMIC_ACQUIRE);
+      d = (long int) (seq - pos);
+      if (!d)
+        {
+          if (__atomic_compare_exchange_n (&q->head, &pos, pos + 1, 1,
+                                           __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            break;
+        }
+      else
+        {
+          if (d < 0)
+            g_thread_yield ();
+          pos = __atomic_load_n (&q->head, __ATOMIC_RELAXED);
+        }
+    }
+  c->value = value;
+  __atomic_store_n (&c->sequence, pos + 1, __ATOMIC_RELEASE);
+#if DEBUG_QUEUE
+  fprintf (stderr, "queue_push: pos=%lu value=%u\n", pos, value);
+#endif
+}
+
+/**
+ * Function to read a value from a lock-free bounded queue.
+ *
+ * If the queue is empty, the thread yields until a value is written.
+ *
+ * \return value.
+ */
+unsigned int
+queue_pop (Queue * q)           ///< Queue struct.
+{
+  QueueCell *c;
+  unsigned long int pos, seq;
+  unsigned int value;
+  long int d;
+  pos = __atomic_load_n (&q->tail, __ATOMIC_RELAXED);
+  for (;;)
+    {
+      c = q->cell + (pos & (QUEUE_SIZE - 1));
+      seq = __atomic_load_n (&c->sequence, __ATOMIC_ACQUIRE);
+      d = (long int) (seq - (pos + 1));
+      if (!d)
+        {
+          if (__atomic_compare_exchange_n (&q->tail, &pos, pos + 1, 1,
+                                           __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            break;
+        }
+      else
+        {
+          if (d < 0)
+            g_thread_yield ();
+          pos = __atomic_load_n (&q->tail, __ATOMIC_RELAXED);
+        }
+    }
+  value = c->value;
+  __atomic_store_n (&c->sequence, pos + QUEUE_SIZE, __ATOMIC_RELEASE);
+#if DEBUG_QUEUE
+  fprintf (stderr, "queue_pop: pos=%lu value=%u\n", pos, value);
+#endif
+  return value;
+}
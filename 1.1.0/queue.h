@@ -0,0 +1,76 @@
+/*
+Ballistic: a software to benchmark ballistic models.
+
+AUTHORS: Javier Burguete Tolosa.
+
+Copyright 2018, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+/**
+ * \file queue.h
+ * \brief Header file to define the lock-free bounded queue data and functions.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2018.
+ */
+#ifndef QUEUE__H
+#define QUEUE__H 1
+
+#define QUEUE_SIZE 1024
+///< number of cells of a queue (it has to be a power of 2).
+#define QUEUE_END 0xffffffffu   ///< value to mark the end of a queue.
+
+/**
+ * \struct QueueCell
+ * \brief struct to define a cell of a lock-free bounded queue.
+ */
+typedef struct
+{
+  unsigned long int sequence;   ///< sequence number of the cell.
+  unsigned int value;           ///< stored value.
+} QueueCell;
+
+/**
+ * \struct Queue
+ * \brief struct to define a lock-free bounded queue of trajectory indices.
+ *
+ * It is a multiple producers and multiple consumers ring buffer (D. Vyukov
+ * algorithm): every cell has a sequence number telling if it is ready to be
+ * written or read on the actual lap, so the producers and the consumers only
+ * synchronize with atomic operations on the cells and on the positions.
+ */
+typedef struct
+{
+  QueueCell cell[QUEUE_SIZE];   ///< array of cells.
+  char pad0[64];                ///< padding to avoid false sharing.
+  unsigned long int head;       ///< position to write.
+  char pad1[64];                ///< padding to avoid false sharing.
+  unsigned long int tail;       ///< position to read.
+  char pad2[64];                ///< padding to avoid false sharing.
+} Queue;
+
+void queue_init (Queue * q);
+void queue_push (Queue * q, unsigned int value);
+unsigned int queue_pop (Queue * q);
+
+#endif
@@ -44,11 +44,15 @@ OF SUCH DAMAGE.
 #include "config.h"
 #include "utils.h"
 #include "equation.h"
+#include "equation-inline.h"
 #include "method.h"
 #include "runge-kutta.h"
 
 #define DEBUG_RUNGE_KUTTA 0     ///< macro to debug the Runge-Kutta functions.
 
+#define RK_LS5_NSTAGES RUNGE_KUTTA_LOW_STORAGE_STAGES
+///< number of stages of the 5th order low-storage Runge-Kutta method.
+
 ///> 1st array of 1st order Runge-Kutta b coefficients.
 static const long double rk_b1_1[1] = { 1.L };
 
@@ -117,6 +121,92 @@ static const long double *rk_b4[4] = { rk_b4_1, rk_b4_2, rk_b4_3, rk_b4_4 };
 static const long double rk_t4[4] = { 0.5L, 0.5L, 1.L, 1.L };
 
 
+///> array of 3rd order low-storage Runge-Kutta a coefficients (Williamson).
+static const long double rk_la3[3] = { 0.L, -5.L / 9.L, -153.L / 128.L };
+
+///> array of 3rd order low-storage Runge-Kutta b coefficients (Williamson).
+static const long double rk_lb3[3] = { 1.L / 3.L, 15.L / 16.L, 8.L / 15.L };
+
+///> array of 3rd order low-storage Runge-Kutta error coefficients.
+static const long double rk_le3[3] =
+  { 10.L / 915.L, -18.L / 915.L, 8.L / 915.L };
+
+
+///> array of 4th order low-storage Runge-Kutta a coefficients
+///> (Carpenter-Kennedy).
+static const long double rk_la4[5] = {
+  0.L,
+  -567301805773.L / 1357537059087.L,
+  -2404267990393.L / 2016746695238.L,
+  -3550918686646.L / 2091501179385.L,
+  -1275806237668.L / 842570457699.L
+};
+
+///> array of 4th order low-storage Runge-Kutta b coefficients
+///> (Carpenter-Kennedy).
+static const long double rk_lb4[5] = {
+  1432997174477.L / 9575080441755.L,
+  5161836677717.L / 13612068292357.L,
+  1720146321549.L / 2090206949498.L,
+  3134564353537.L / 4481467310338.L,
+  2277821191437.L / 14882151754819.L
+};
+
+///> array of 4th order low-storage Runge-Kutta error coefficients.
+static const long double rk_le4[5] = {
+  -0.106215645100237239442L,
+  0.228379652720015083872L,
+  -0.161689516665564226005L,
+  0.0362046371996724252383L,
+  0.00332087184611395633703L
+};
+
+
+///> array of 5th order low-storage Runge-Kutta a coefficients (solution of
+///> the order conditions of the 10 stages 2N-storage form with a2=-0.662 and
+///> b1=0.151).
+static const long double rk_la5[RK_LS5_NSTAGES] = {
+  0.L,
+  -0.662L,
+  -1.534409072429562219677L,
+  -1.039506613319222559038L,
+  -0.1292768580160877416234L,
+  -0.8752412299284231268212L,
+  -1.675501901802966696406L,
+  -0.2876995761973151891165L,
+  -0.8025575209561876358031L,
+  0.7292390217980633230433L
+};
+
+///> array of 5th order low-storage Runge-Kutta b coefficients.
+static const long double rk_lb5[RK_LS5_NSTAGES] = {
+  0.151L,
+  0.4274865286211339028784L,
+  0.3878185056078094116143L,
+  0.1958694690137149287794L,
+  0.2216622686716214721806L,
+  -0.127334493405336369003L,
+  -0.1357054170869767467394L,
+  0.2339903760619294953647L,
+  0.1952285032496557482384L,
+  0.05799101380086969624047L
+};
+
+///> array of 5th order low-storage Runge-Kutta error coefficients.
+static const long double rk_le5[RK_LS5_NSTAGES] = {
+  -0.009866669697969706155484L,
+  0.01153294335924800656595L,
+  0.0109096055779432387462L,
+  0.02862935743474981816597L,
+  -0.04715196553496326378699L,
+  0.05758227121550641843589L,
+  -0.0712349031488349527276L,
+  -0.04315711322230172207892L,
+  0.1655029304006546223221L,
+  -0.1027464563840324594872L
+};
+
+
 /**
  * Function to init the coefficients of the 1st order Runge-Kutta method.
  */
@@ -188,6 +278,91 @@ runge_kutta_init_4 (RungeKutta * rk)    ///< RungeKutta struct.
 #endif
 }
 
+/**
+ * Function to init the stage times of a low-storage Runge-Kutta method.
+ *
+ * The times are calculated from the a and b coefficients, as the stage values
+ * of the 2N-storage form for \f$y'=1\f$, so they satisfy exactly the
+ * conditions of the time-dependent accelerations.
+ */
+static inline void
+runge_kutta_init_low_storage_times (RungeKutta * rk)    ///< RungeKutta struct.
+{
+  long double q, c;
+  unsigned int i;
+  q = c = 0.L;
+  for (i = 0; i < rk->nstages; ++i)
+    {
+      rk->lt[i] = c;
+      q = rk->la[i] * q + 1.L;
+      c += rk->lb[i] * q;
+    }
+  rk->t = rk->lt;
+}
+
+/**
+ * Function to init the coefficients of the 3rd order low-storage Runge-Kutta
+ *   method.
+ */
+static inline void
+runge_kutta_init_low_storage_3 (RungeKutta * rk)        ///< RungeKutta struct.
+{
+#if DEBUG_RUNGE_KUTTA
+  fprintf (stderr, "runge_kutta_init_low_storage_3: start\n");
+#endif
+  method_init (RUNGE_KUTTA_METHOD (rk), 3, 3);
+  rk->nstages = 3;
+  rk->la = rk_la3;
+  rk->lb = rk_lb3;
+  runge_kutta_init_low_storage_times (rk);
+  rk->e = rk_le3;
+#if DEBUG_RUNGE_KUTTA
+  fprintf (stderr, "runge_kutta_init_low_storage_3: end\n");
+#endif
+}
+
+/**
+ * Function to init the coefficients of the 4th order low-storage Runge-Kutta
+ *   method.
+ */
+static inline void
+runge_kutta_init_low_storage_4 (RungeKutta * rk)        ///< RungeKutta struct.
+{
+#if DEBUG_RUNGE_KUTTA
+  fprintf (stderr, "runge_kutta_init_low_storage_4: start\n");
+#endif
+  method_init (RUNGE_KUTTA_METHOD (rk), 5, 4);
+  rk->nstages = 5;
+  rk->la = rk_la4;
+  rk->lb = rk_lb4;
+  runge_kutta_init_low_storage_times (rk);
+  rk->e = rk_le4;
+#if DEBUG_RUNGE_KUTTA
+  fprintf (stderr, "runge_kutta_init_low_storage_4: end\n");
+#endif
+}
+
+/**
+ * Function to init the coefficients of the 5th order low-storage Runge-Kutta
+ *   method.
+ */
+static inline void
+runge_kutta_init_low_storage_5 (RungeKutta * rk)        ///< RungeKutta struct.
+{
+#if DEBUG_RUNGE_KUTTA
+  fprintf (stderr, "runge_kutta_init_low_storage_5: start\n");
+#endif
+  method_init (RUNGE_KUTTA_METHOD (rk), RK_LS5_NSTAGES, 5);
+  rk->nstages = RK_LS5_NSTAGES;
+  rk->la = rk_la5;
+  rk->lb = rk_lb5;
+  runge_kutta_init_low_storage_times (rk);
+  rk->e = rk_le5;
+#if DEBUG_RUNGE_KUTTA
+  fprintf (stderr, "runge_kutta_init_low_storage_5: end\n");
+#endif
+}
+
 /**
  * Function to init the variables used by the Runge-Kutta methods.
  */
@@ -199,21 +374,110 @@ runge_kutta_init_variables (RungeKutta * rk)
   fprintf (stderr, "runge_kutta_init_variables: start\n");
 #endif
 	m = RUNGE_KUTTA_METHOD (rk);
-	m->nsteps = 1;
-  method_init_variables (m);
+
+  // the low-storage methods work on the registers of the RungeKutta struct and
+  // do not need the stage vectors
+  if (rk->la)
+    {
+      m->r0 = m->r1 = m->r2 = NULL;
+      m->et0 = m->et1 = 0.L;
+    }
+  else
+    {
+      m->nsteps = 1;
+      method_init_variables (m);
+    }
 #if DEBUG_RUNGE_KUTTA
   fprintf (stderr, "runge_kutta_init_variables: end\n");
 #endif
 }
 
 /**
- * Function to perform a step of the Runge-Kutta method.
+ * Function to perform a step of the low-storage Runge-Kutta method with an
+ *   acceleration function.
+ *
+ * The stages are calculated on the 2N-storage form:
+ * \f$q_i=a_i\,q_{i-1}+\Delta t\,f\left(y_{i-1}\right)\f$,
+ * \f$y_i=y_{i-1}+b_i\,q_i\f$, with the state updated in place. The 1st stage
+ * uses the acceleration of the previous step. With error control, the error
+ * coefficients accumulate the error estimate on a third register.
  */
-void
-runge_kutta_step (RungeKutta * rk,      ///< RungeKutta struct.
-                  Equation * eq,        ///< Equation struct.
-                  long double t,        ///< current time.
-                  long double dt)       ///< time step size.
+static inline __attribute__ ((always_inline)) void
+runge_kutta_step_low_storage (RungeKutta * rk,  ///< RungeKutta struct.
+                              Equation * eq,    ///< Equation struct.
+                              long double t,    ///< current time.
+                              long double dt,   ///< time step size.
+                              void (*acceleration) (Equation *,
+                                                    long double *,
+                                                    long double *,
+                                                    long double *,
+                                                    long double))
+  ///< acceleration function.
+{
+  long double a, b, e;
+  unsigned int i, j, n, error_dt;
+#if DEBUG_RUNGE_KUTTA
+  fprintf (stderr, "runge_kutta_step_low_storage: start\n");
+  fprintf (stderr, "runge_kutta_step_low_storage: t=%Lg dt=%Lg\n", t, dt);
+#endif
+  error_dt = RUNGE_KUTTA_METHOD (rk)->error_dt;
+  n = rk->nstages;
+  for (i = 0; i < n; ++i)
+    {
+      if (i)
+        acceleration (eq, r0, r1, r2, t + rk->t[i] * dt);
+      a = rk->la[i];
+      b = rk->lb[i];
+      for (j = 0; j < 3; ++j)
+        {
+          rk->q0[j] = (i) ? a * rk->q0[j] + dt * r1[j] : dt * r1[j];
+          rk->q1[j] = (i) ? a * rk->q1[j] + dt * r2[j] : dt * r2[j];
+        }
+      if (error_dt)
+        {
+          e = dt * rk->e[i];
+          for (j = 0; j < 3; ++j)
+            {
+              rk->d0[j] = (i) ? rk->d0[j] + e * r1[j] : e * r1[j];
+              rk->d1[j] = (i) ? rk->d1[j] + e * r2[j] : e * r2[j];
+            }
+        }
+      for (j = 0; j < 3; ++j)
+        {
+          r0[j] += b * rk->q0[j];
+          r1[j] += b * rk->q1[j];
+        }
+#if DEBUG_RUNGE_KUTTA
+      fprintf (stderr, "runge_kutta_step_low_storage: t%u=%Lg\n", i,
+               rk->t[i]);
+#endif
+    }
+  acceleration (eq, r0, r1, r2, t + dt);
+#if DEBUG_RUNGE_KUTTA
+  for (i = 0; i < 3; ++i)
+    fprintf (stderr, "runge_kutta_step_low_storage: r0[%u]=%Lg\n", i, r0[i]);
+  for (i = 0; i < 3; ++i)
+    fprintf (stderr, "runge_kutta_step_low_storage: r1[%u]=%Lg\n", i, r1[i]);
+  fprintf (stderr, "runge_kutta_step_low_storage: end\n");
+#endif
+}
+
+/**
+ * Function to perform a step of the Runge-Kutta method with an acceleration
+ *   function.
+ *
+ * It is always inlined, so with a constant acceleration function the call is
+ * direct and the acceleration is inlined too.
+ */
+static inline __attribute__ ((always_inline)) void
+runge_kutta_step_kernel (RungeKutta * rk,       ///< RungeKutta struct.
+                         Equation * eq, ///< Equation struct.
+                         long double t, ///< current time.
+                         long double dt,        ///< time step size.
+                         void (*acceleration) (Equation *, long double *,
+                                               long double *, long double *,
+                                               long double))
+  ///< acceleration function.
 {
   Method *m;
   const long double *b;
@@ -222,6 +486,11 @@ runge_kutta_step (RungeKutta * rk,      ///< RungeKutta struct.
   fprintf (stderr, "runge_kutta_step: start\n");
   fprintf (stderr, "runge_kutta_step: t=%Lg dt=%Lg\n", t, dt);
 #endif
+  if (rk->la)
+    {
+      runge_kutta_step_low_storage (rk, eq, t, dt, acceleration);
+      return;
+    }
   m = RUNGE_KUTTA_METHOD (rk);
   memcpy (m->r0[0], r0, 3 * sizeof (long double));
   memcpy (m->r1[0], r1, 3 * sizeof (long double));
@@ -251,8 +520,7 @@ runge_kutta_step (RungeKutta * rk,      ///< RungeKutta struct.
           m->r1[i][1] += dt * b[j] * m->r2[j][1];
           m->r1[i][2] += dt * b[j] * m->r2[j][2];
         }
-      equation_acceleration (eq, m->r0[i], m->r1[i], m->r2[i],
-                             t + rk->t[i - 1] * dt);
+      acceleration (eq, m->r0[i], m->r1[i], m->r2[i], t + rk->t[i - 1] * dt);
 #if DEBUG_RUNGE_KUTTA
       fprintf (stderr, "runge_kutta_step: t%u=%Lg\n", i, rk->t[i - 1]);
 #endif
@@ -270,10 +538,38 @@ runge_kutta_step (RungeKutta * rk,      ///< RungeKutta struct.
 #endif
 }
 
+/**
+ * Function to perform a step of the Runge-Kutta method.
+ */
+CPU_DISPATCH void
+runge_kutta_step (RungeKutta * rk,      ///< RungeKutta struct.
+                  Equation * eq,        ///< Equation struct.
+                  long double t,        ///< current time.
+                  long double dt)       ///< time step size.
+{
+  runge_kutta_step_kernel (rk, eq, t, dt, equation_acceleration);
+}
+
+/**
+ * Macro to define a step of the Runge-Kutta method on an equation type.
+ */
+#define RUNGE_KUTTA_STEP(type) \
+CPU_DISPATCH void \
+runge_kutta_step_##type (RungeKutta * rk, Equation * eq, long double t, \
+                         long double dt) \
+{ \
+  runge_kutta_step_kernel (rk, eq, t, dt, equation_acceleration_##type); \
+}
+
+RUNGE_KUTTA_STEP (0)
+RUNGE_KUTTA_STEP (1)
+RUNGE_KUTTA_STEP (2)
+RUNGE_KUTTA_STEP (3)
+
 /**
  * Function to estimate the error on a Runge-Kutta step.
  */
-void
+CPU_DISPATCH void
 runge_kutta_error (RungeKutta * rk,     ///< Runge-Kutta struct.
                    long double dt)      ///< time step size.
 {
@@ -284,6 +580,12 @@ runge_kutta_error (RungeKutta * rk,     ///< Runge-Kutta struct.
   fprintf (stderr, "runge_kutta_error: start\n");
 #endif
   m = RUNGE_KUTTA_METHOD (rk);
+  if (rk->la)
+    {
+      memcpy (e0, rk->d0, 3 * sizeof (long double));
+      memcpy (e1, rk->d1, 3 * sizeof (long double));
+      goto norm;
+    }
   e0[0] = e0[1] = e0[2] = e1[0] = e1[1] = e1[2] = 0.L;
   for (i = 0; i < m->nsteps; ++i)
     {
@@ -294,6 +596,7 @@ runge_kutta_error (RungeKutta * rk,     ///< Runge-Kutta struct.
       e1[1] += dt * rk->e[i] * m->r2[i][1];
       e1[2] += dt * rk->e[i] * m->r2[i][2];
     }
+norm:
   m->e0 = sqrtl (e0[0] * e0[0] + e0[1] * e0[1] + e0[2] * e0[2]);
   m->e1 = sqrtl (e1[0] * e1[0] + e1[1] * e1[1] + e1[2] * e1[2]);
   m->et0 += m->e0;
@@ -306,13 +609,28 @@ runge_kutta_error (RungeKutta * rk,     ///< Runge-Kutta struct.
 }
 
 /**
- * Function to run the Runge-Kutta method bucle.
+ * Function to run the Runge-Kutta method bucle with the equation functions.
+ *
+ * It is always inlined, so with constant equation functions and error control
+ * type the bucle has not indirect calls and the equation functions are
+ * inlined.
  *
  * \return final time. 
  */
-long double
-runge_kutta_run (RungeKutta * rk,       ///< RungeKutta struct.
-                 Equation * eq) ///< Equation struct.
+static inline __attribute__ ((always_inline)) long double
+runge_kutta_run_kernel (RungeKutta * rk,        ///< RungeKutta struct.
+                        Equation * eq,  ///< Equation struct.
+                        void (*acceleration) (Equation *, long double *,
+                                              long double *, long double *,
+                                              long double),
+                        ///< acceleration function.
+                        long double (*step_size) (Equation *),
+                        ///< time step size function.
+                        int (*land) (Equation *, long double, long double *,
+                                     long double *),
+                        ///< landing function.
+                        unsigned int error_dt)
+  ///< type of error time step size control.
 {
   Method *m;
   long double t, to, dt, dto, et0o, et1o;
@@ -332,7 +650,7 @@ runge_kutta_run (RungeKutta * rk,       ///< RungeKutta struct.
     {
 
       // time step size
-      if (t > 0.L && m->error_dt)
+      if (t > 0.L && error_dt)
         {
           dto = dt;
           dt = method_dt (m, dt);
@@ -340,6 +658,8 @@ runge_kutta_run (RungeKutta * rk,       ///< RungeKutta struct.
           // revert the step if big error
           if (dt < m->beta * dto)
             {
+              --naccepted;
+              ++nrejected;
               t = to;
               m->et0 = et0o;
               m->et1 = et1o;
@@ -349,11 +669,11 @@ runge_kutta_run (RungeKutta * rk,       ///< RungeKutta struct.
             }
         }
       else
-        dt = equation_step_size (eq);
+        dt = step_size (eq);
 
       // checking trajectory end
       to = t;
-      if (equation_land (eq, to, &t, &dt))
+      if (land (eq, to, &t, &dt))
         break;
 #if DEBUG_RUNGE_KUTTA
       fprintf (stderr, "runge_kutta_run: t=%Lg dt=%Lg\n", t, dt);
@@ -365,10 +685,11 @@ runge_kutta_run (RungeKutta * rk,       ///< RungeKutta struct.
       memcpy (ro2, r2, 3 * sizeof (long double));
 
       // Runge-Kutta step
-      runge_kutta_step (rk, eq, to, dt);
+      runge_kutta_step_kernel (rk, eq, to, dt, acceleration);
+      ++naccepted;
 
       // error estimate
-      if (m->error_dt)
+      if (error_dt)
         {
           et0o = m->et0;
           et1o = m->et1;
@@ -381,6 +702,72 @@ runge_kutta_run (RungeKutta * rk,       ///< RungeKutta struct.
   return t;
 }
 
+/**
+ * Function to run the Runge-Kutta method bucle with the equation function
+ *   pointers.
+ *
+ * \return final time.
+ */
+static CPU_DISPATCH long double
+runge_kutta_run_generic (RungeKutta * rk,       ///< RungeKutta struct.
+                         Equation * eq) ///< Equation struct.
+{
+  return runge_kutta_run_kernel (rk, eq, equation_acceleration,
+                                 equation_step_size, equation_land,
+                                 RUNGE_KUTTA_METHOD (rk)->error_dt);
+}
+
+/**
+ * Macro to define a Runge-Kutta method bucle specialized on an equation type,
+ *   a landing type, a time step size function and an error control type.
+ */
+#define RUNGE_KUTTA_RUN(type, land, size, error) \
+static CPU_DISPATCH long double \
+runge_kutta_run_##type##_##land##_##size##_##error (RungeKutta * rk, \
+                                                    Equation * eq) \
+{ \
+  return runge_kutta_run_kernel (rk, eq, equation_acceleration_##type, \
+                                 equation_step_size_##size, \
+                                 equation_land_##land, error); \
+}
+
+EQUATION_SPECIALIZE (RUNGE_KUTTA_RUN)
+
+/**
+ * Macro to define an element of the array of specialized Runge-Kutta method
+ *   bucles.
+ */
+#define RUNGE_KUTTA_RUN_ELEMENT(type, land, size, error) \
+  [type][size][land][error] = runge_kutta_run_##type##_##land##_##size##_##error,
+
+///> array of specialized Runge-Kutta method bucles.
+static long double (*const runge_kutta_run_specialized[4][4][4][2])
+  (RungeKutta * rk, Equation * eq) =
+{
+EQUATION_SPECIALIZE (RUNGE_KUTTA_RUN_ELEMENT)
+};
+
+/**
+ * Function to run the Runge-Kutta method bucle.
+ *
+ * The bucle specialized on the equation data is selected by a single indirect
+ * call by trajectory. The not specialized combinations run with the equation
+ * function pointers.
+ *
+ * \return final time. 
+ */
+long double
+runge_kutta_run (RungeKutta * rk,       ///< RungeKutta struct.
+                 Equation * eq) ///< Equation struct.
+{
+  long double (*run) (RungeKutta *, Equation *);
+  run = runge_kutta_run_specialized[eq->type][equation_step_size_type (eq)]
+    [eq->land_type][RUNGE_KUTTA_METHOD (rk)->error_dt];
+  if (!run)
+    run = runge_kutta_run_generic;
+  return run (rk, eq);
+}
+
 /**
  * Function to free the memory used by a RungeKutta struct.
  */
@@ -390,7 +777,8 @@ runge_kutta_delete (RungeKutta * rk)    ///< RungeKutta struct.
 #if DEBUG_RUNGE_KUTTA
   fprintf (stderr, "runge_kutta_delete: start\n");
 #endif
-  method_delete (RUNGE_KUTTA_METHOD (rk));
+  if (!rk->la)
+    method_delete (RUNGE_KUTTA_METHOD (rk));
 #if DEBUG_RUNGE_KUTTA
   fprintf (stderr, "runge_kutta_delete: end\n");
 #endif
@@ -408,10 +796,12 @@ runge_kutta_read_xml (RungeKutta * rk,  ///< RungeKutta struct.
   const char *message[] = {
     "Bad type",
     "Bad method data",
-    "Unknown Runge-Kutta method"
+    "Unknown Runge-Kutta method",
+    "Bad low-storage",
+    "Unknown low-storage Runge-Kutta method"
   };
   int e, error_code;
-  unsigned int type;
+  unsigned int type, low_storage;
 #if DEBUG_RUNGE_KUTTA
   fprintf (stderr, "runge_kutta_read_xml: start\n");
 #endif
@@ -426,6 +816,33 @@ runge_kutta_read_xml (RungeKutta * rk,  ///< RungeKutta struct.
       e = 1;
       goto fail;
     }
+  low_storage
+    = xml_node_get_uint_with_default (node, XML_LOW_STORAGE, 0, &error_code);
+  if (error_code || low_storage > 1)
+    {
+      e = 3;
+      goto fail;
+    }
+  rk->la = NULL;
+  if (low_storage)
+    {
+      switch (type)
+        {
+        case 3:
+          runge_kutta_init_low_storage_3 (rk);
+          break;
+        case 4:
+          runge_kutta_init_low_storage_4 (rk);
+          break;
+        case 5:
+          runge_kutta_init_low_storage_5 (rk);
+          break;
+        default:
+          e = 4;
+          goto fail;
+        }
+      goto end;
+    }
   switch (type)
     {
     case 1:
@@ -444,6 +861,7 @@ runge_kutta_read_xml (RungeKutta * rk,  ///< RungeKutta struct.
       e = 2;
       goto fail;
     }
+end:
 #if DEBUG_RUNGE_KUTTA
   fprintf (stderr, "runge_kutta_read_xml: success\n");
   fprintf (stderr, "runge_kutta_read_xml: end\n");
@@ -36,9 +36,17 @@ OF SUCH DAMAGE.
 #ifndef RUNGE_KUTTA__H
 #define RUNGE_KUTTA__H 1
 
+#define RUNGE_KUTTA_LOW_STORAGE_STAGES 10
+///< maximum number of stages of the low-storage Runge-Kutta methods.
+
 /**
  * \struct RungeKutta
  * \brief struct to define a Runge-Kutta method.
+ *
+ * The low-storage methods are defined by the a and b coefficients of the
+ * 2N-storage form: only the state and a register of increments are stored,
+ * and a third register accumulates the error estimate with error control. The
+ * stage vectors of the Method struct are not allocated.
  */
 typedef struct
 {
@@ -46,6 +54,16 @@ typedef struct
   const long double **b;        ///< matrix of b-coefficients.
   const long double *t;         ///< array of t-coefficients.
   const long double *e;         ///< array of error coefficients.
+  const long double *la;
+  ///< array of low-storage a-coefficients (NULL: not low-storage method).
+  const long double *lb;        ///< array of low-storage b-coefficients.
+  long double q0[3];            ///< low-storage position increment register.
+  long double q1[3];            ///< low-storage velocity increment register.
+  long double d0[3];            ///< low-storage position error register.
+  long double d1[3];            ///< low-storage velocity error register.
+  long double lt[RUNGE_KUTTA_LOW_STORAGE_STAGES];
+  ///< array of low-storage t-coefficients.
+  unsigned int nstages;         ///< number of low-storage stages.
 } RungeKutta;
 
 #define RUNGE_KUTTA_METHOD(rk) ((Method *)rk->method)
@@ -54,6 +72,14 @@ typedef struct
 void runge_kutta_init_variables (RungeKutta * rk);
 void runge_kutta_step (RungeKutta * rk, Equation * eq, long double t,
                        long double dt);
+void runge_kutta_step_0 (RungeKutta * rk, Equation * eq, long double t,
+                         long double dt);
+void runge_kutta_step_1 (RungeKutta * rk, Equation * eq, long double t,
+                         long double dt);
+void runge_kutta_step_2 (RungeKutta * rk, Equation * eq, long double t,
+                         long double dt);
+void runge_kutta_step_3 (RungeKutta * rk, Equation * eq, long double t,
+                         long double dt);
 void runge_kutta_error (RungeKutta * rk, long double dt);
 long double runge_kutta_run (RungeKutta * rk, Equation * eq);
 void runge_kutta_delete (RungeKutta * rk);
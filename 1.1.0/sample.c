@@ -0,0 +1,665 @@
+/*
+Ballistic: a software to benchmark ballistic models.
+
+AUTHORS: Javier Burguete Tolosa.
+
+Copyright 2018, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+/**
+ * \file sample.c
+ * \brief Source file to define the trajectories sample data and functions.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2018.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <gsl/gsl_rng.h>
+#include <gsl/gsl_qrng.h>
+#include <libxml/parser.h>
+#include <glib.h>
+#include "config.h"
+#include "utils.h"
+#include "equation.h"
+#include "philox.h"
+#include "sample.h"
+#include "profile.h"
+
+#define DEBUG_SAMPLE 0          ///< macro to debug the sample functions.
+
+/**
+ * Function to get the next free column of the table.
+ *
+ * \return pointer to the column.
+ */
+static inline long double *
+sample_column (Sample * s)      ///< Sample struct.
+{
+  return s->data + (s->ncolumns++) * (size_t) s->n;
+}
+
+/**
+ * Function to allocate the columns of the table.
+ */
+static inline void
+sample_alloc (Sample * s,       ///< Sample struct.
+              Equation * eq,    ///< Equation struct.
+              unsigned int n)   ///< number of trajectories.
+{
+  unsigned int i, ncolumns;
+#if DEBUG_SAMPLE
+  fprintf (stderr, "sample_alloc: start\n");
+#endif
+
+  // columns of initial conditions and reference solution
+  ncolumns = 12;
+
+  // columns of friction coefficient and invariants requiring transcendental
+  // functions
+  switch (eq->type)
+    {
+    case 1:
+    case 3:
+      ncolumns += 1;
+      break;
+    case 2:
+      ncolumns += 5;
+    }
+
+  s->n = n;
+  s->ncolumns = 0;
+  s->data
+    = (long double *) g_malloc (ncolumns * (size_t) n * sizeof (long double));
+  for (i = 0; i < 3; ++i)
+    s->v[i] = sample_column (s);
+  for (i = 0; i < 2; ++i)
+    s->w[i] = sample_column (s);
+  for (i = 0; i < 3; ++i)
+    s->r0[i] = sample_column (s);
+  for (i = 0; i < 3; ++i)
+    s->r1[i] = sample_column (s);
+  s->t = sample_column (s);
+  s->lambda = s->gl = s->g_l = s->alpha = s->calpha = NULL;
+  switch (eq->type)
+    {
+    case 2:
+      s->gl = sample_column (s);
+      s->g_l = sample_column (s);
+      s->alpha = sample_column (s);
+      s->calpha = sample_column (s);
+      // fall through
+    case 1:
+    case 3:
+      s->lambda = sample_column (s);
+    }
+#if DEBUG_SAMPLE
+  fprintf (stderr, "sample_alloc: ncolumns=%u\n", s->ncolumns);
+  fprintf (stderr, "sample_alloc: end\n");
+#endif
+}
+
+/**
+ * Function to read the sampling data on a XML node.
+ *
+ * \return 1 on success, 0 on error.
+ */
+int
+sample_read_xml (Sample * s,    ///< Sample struct.
+                 xmlNode * node)        ///< XML node.
+{
+  const char *message[] = {
+    "Unknown sampling type",
+    "Bad scramble seed",
+    "Bad seed",
+    "Bad offset",
+    "Bad sort",
+    "Bad batch"
+  };
+  xmlChar *buffer;
+  int e, error_code;
+#if DEBUG_SAMPLE
+  fprintf (stderr, "sample_read_xml: start\n");
+#endif
+  buffer = xmlGetProp (node, XML_SAMPLING);
+  if (!buffer || !xmlStrcmp (buffer, XML_RANDOM))
+    s->type = 0;
+  else if (!xmlStrcmp (buffer, XML_SOBOL))
+    s->type = 1;
+  else if (!xmlStrcmp (buffer, XML_HALTON))
+    s->type = 2;
+  else if (!xmlStrcmp (buffer, XML_PHILOX))
+    s->type = 3;
+  else
+    {
+      xmlFree (buffer);
+      e = 0;
+      goto fail;
+    }
+  xmlFree (buffer);
+  s->scramble
+    = xml_node_get_uint_with_default (node, XML_SCRAMBLE, 0, &error_code);
+  if (error_code)
+    {
+      e = 1;
+      goto fail;
+    }
+  s->seed = xml_node_get_uint_with_default (node, XML_SEED, 0, &error_code);
+  if (error_code)
+    {
+      e = 2;
+      goto fail;
+    }
+  s->offset
+    = xml_node_get_uint_with_default (node, XML_OFFSET, 0, &error_code);
+  if (error_code)
+    {
+      e = 3;
+      goto fail;
+    }
+  s->sort = xml_node_get_uint_with_default (node, XML_SORT, 0, &error_code);
+  if (error_code || s->sort > 1)
+    {
+      e = 4;
+      goto fail;
+    }
+  s->batch = xml_node_get_uint_with_default (node, XML_BATCH, 0, &error_code);
+  if (error_code || s->batch > 1)
+    {
+      e = 5;
+      goto fail;
+    }
+  s->data = NULL;
+  s->order = NULL;
+  s->ready = NULL;
+  s->data_ready = NULL;
+#if DEBUG_SAMPLE
+  fprintf (stderr, "sample_read_xml: type=%u scramble=%u seed=%u offset=%u\n",
+           s->type, s->scramble, s->seed, s->offset);
+  fprintf (stderr, "sample_read_xml: success\n");
+  fprintf (stderr, "sample_read_xml: end\n");
+#endif
+  return 1;
+
+fail:
+  error_add (message[e]);
+#if DEBUG_SAMPLE
+  fprintf (stderr, "sample_read_xml: error\n");
+  fprintf (stderr, "sample_read_xml: end\n");
+#endif
+  return 0;
+}
+
+/**
+ * Function to get the uniform numbers to init a trajectory.
+ *
+ * With quasi-random sampling, the points are scrambled by a random shift
+ * modulo 1 (Cranley-Patterson rotation). Runs with different scramble seeds
+ * are independent unbiased estimates, so they can be used to estimate the
+ * error bars.
+ */
+static inline void
+sample_uniform (Sample * s,     ///< Sample struct.
+                Equation * eq,  ///< Equation struct.
+                gsl_rng * rng,  ///< gsl_rng struct.
+                gsl_qrng * qrng,        ///< gsl_qrng struct.
+                const double *shift,    ///< array of scramble shifts.
+                double *u)      ///< array of uniform numbers.
+{
+  unsigned int i;
+  i = (eq->type) ? 0 : 1;
+  switch (s->type)
+    {
+    case 0:
+      for (; i < 5; ++i)
+        u[i] = gsl_rng_uniform (rng);
+      break;
+    default:
+      gsl_qrng_get (qrng, u + i);
+      for (; i < 5; ++i)
+        {
+          u[i] += shift[i];
+          if (u[i] >= 1.)
+            u[i] -= 1.;
+        }
+    }
+}
+
+/**
+ * Function to calculate and to store the reference solution of a trajectory.
+ */
+void
+sample_solve (Sample * s,       ///< Sample struct.
+              Equation * eq,
+              ///< Equation struct with the trajectory initial conditions.
+              unsigned int i)   ///< trajectory index.
+{
+  long double sr0[3], sr1[3];
+  unsigned long long int t0;
+  unsigned int j;
+  t0 = profile_clock ();
+  switch (eq->land_type)
+    {
+    case 0:
+      equation_solution (eq, sr0, sr1, eq->tf);
+      s->t[i] = eq->tf;
+      break;
+    default:
+      s->t[i] = equation_solve (eq, sr0, sr1);
+    }
+  for (j = 0; j < 3; ++j)
+    {
+      s->r0[j][i] = sr0[j];
+      s->r1[j][i] = sr1[j];
+    }
+  profile_add (PROFILE_REFERENCE, profile_clock () - t0);
+#if DEBUG_SAMPLE
+  fprintf (stderr, "sample_solve: i=%u t=%Lg\n", i, s->t[i]);
+#endif
+}
+
+/**
+ * Function to store a trajectory on the table.
+ *
+ * Without a ready function, the reference solution is calculated here.
+ * Otherwise the ready function is called to pass the trajectory index to the
+ * next stages of a pipeline.
+ */
+static inline void
+sample_store (Sample * s,       ///< Sample struct.
+              Equation * eq,    ///< Equation struct.
+              unsigned int i)   ///< trajectory index.
+{
+  unsigned int j;
+  for (j = 0; j < 3; ++j)
+    s->v[j][i] = eq->v[j];
+  for (j = 0; j < 2; ++j)
+    s->w[j][i] = eq->w[j];
+  switch (eq->type)
+    {
+    case 2:
+      s->gl[i] = eq->gl;
+      s->g_l[i] = eq->g_l;
+      s->alpha[i] = eq->alpha;
+      s->calpha[i] = eq->calpha;
+      // fall through
+    case 1:
+    case 3:
+      s->lambda[i] = eq->lambda;
+    }
+  if (s->ready)
+    s->ready (s->data_ready, i);
+  else if (!s->batch)
+    sample_solve (s, eq, i);
+}
+
+/**
+ * Function to calculate and to store the reference solutions of a list of
+ *   trajectories by batches.
+ *
+ * The initial conditions are converted to columns of double precision numbers
+ * and the solutions are calculated by the vectorizable batch functions.
+ */
+void
+sample_solve_list (Sample * s,  ///< Sample struct.
+                   Equation * eq,       ///< Equation struct.
+                   const unsigned int *list,
+                   ///< array of trajectory indices (NULL: all the trajectories).
+                   unsigned int n)      ///< number of trajectories.
+{
+  double *x, *y, *t;
+  unsigned long long int t0;
+  unsigned int i, j, k, l, nb;
+#if DEBUG_SAMPLE
+  fprintf (stderr, "sample_solve_list: start\n");
+#endif
+  t0 = profile_clock ();
+  x = (double *) g_malloc (13 * SAMPLE_BATCH * sizeof (double));
+  y = x + 6 * SAMPLE_BATCH;
+  t = y + 6 * SAMPLE_BATCH;
+  for (i = 0; i < n; i += nb)
+    {
+      nb = (n - i < SAMPLE_BATCH) ? n - i : SAMPLE_BATCH;
+      for (k = 0; k < nb; ++k)
+        {
+          l = (list) ? list[i + k] : i + k;
+          x[k] = (eq->type) ? (double) s->lambda[l] : 0.;
+          x[nb + k] = (double) s->v[0][l];
+          x[2 * nb + k] = (double) s->v[1][l];
+          x[3 * nb + k] = (double) s->v[2][l];
+          x[4 * nb + k] = (double) s->w[0][l];
+          x[5 * nb + k] = (double) s->w[1][l];
+        }
+      switch (eq->land_type)
+        {
+        case 0:
+          for (k = 0; k < nb; ++k)
+            t[k] = (double) eq->tf;
+          equation_solution_batch (eq, x, t, nb, y);
+          break;
+        default:
+          equation_solve_batch (eq, x, nb, t, y);
+        }
+      for (k = 0; k < nb; ++k)
+        {
+          l = (list) ? list[i + k] : i + k;
+          s->t[l] = t[k];
+          for (j = 0; j < 3; ++j)
+            {
+              s->r0[j][l] = y[j * nb + k];
+              s->r1[j][l] = y[(j + 3) * nb + k];
+            }
+        }
+    }
+  g_free (x);
+  profile_add (PROFILE_REFERENCE, profile_clock () - t0);
+#if DEBUG_SAMPLE
+  fprintf (stderr, "sample_solve_list: end\n");
+#endif
+}
+
+/**
+ * Function to generate a sample of trajectories with the Philox generator.
+ *
+ * The uniform numbers and the initial conditions are calculated by batches
+ * of trajectories with vectorizable functions.
+ */
+static inline void
+sample_init_philox (Sample * s, ///< Sample struct.
+                    Equation * eq)      ///< Equation struct.
+{
+  double *u, *x;
+  unsigned int i, j, k, n, nb;
+#if DEBUG_SAMPLE
+  fprintf (stderr, "sample_init_philox: start\n");
+#endif
+  u = (double *) g_malloc (11 * SAMPLE_BATCH * sizeof (double));
+  x = u + 5 * SAMPLE_BATCH;
+  j = (eq->type) ? 0 : 1;
+  n = s->n;
+  eq->r[0] = eq->r[1] = 0.L;
+  for (i = 0; i < n; i += nb)
+    {
+      nb = (n - i < SAMPLE_BATCH) ? n - i : SAMPLE_BATCH;
+      philox_uniform_batch (s->seed, s->offset + (unsigned long int) i, nb,
+                            u + j * nb, 5 - j);
+      equation_init_batch (eq, u, nb, x);
+      for (k = 0; k < nb; ++k)
+        {
+          if (eq->type)
+            eq->lambda = x[k];
+          eq->v[0] = x[nb + k];
+          eq->v[1] = x[2 * nb + k];
+          eq->v[2] = x[3 * nb + k];
+          eq->w[0] = x[4 * nb + k];
+          eq->w[1] = x[5 * nb + k];
+          equation_invariants (eq);
+          sample_store (s, eq, i + k);
+        }
+    }
+  g_free (u);
+#if DEBUG_SAMPLE
+  fprintf (stderr, "sample_init_philox: end\n");
+#endif
+}
+
+/**
+ * \struct SampleCost
+ * \brief struct to sort the trajectories by cost.
+ */
+typedef struct
+{
+  long double cost;             ///< predicted cost.
+  unsigned int index;           ///< trajectory index.
+} SampleCost;
+
+/**
+ * Function to compare the costs of two trajectories.
+ *
+ * \return -1 if the 1st trajectory goes first, 1 otherwise.
+ */
+static int
+sample_cost_compare (const void *a,     ///< 1st SampleCost struct.
+                     const void *b)     ///< 2nd SampleCost struct.
+{
+  const SampleCost *ca = (const SampleCost *) a, *cb = (const SampleCost *) b;
+  if (ca->cost != cb->cost)
+    return (ca->cost > cb->cost) ? -1 : 1;
+  return (ca->index < cb->index) ? -1 : 1;
+}
+
+/**
+ * Function to sort the trajectories by decreasing predicted cost.
+ *
+ * The number of steps of a trajectory is predicted as the reference final time
+ * divided by the time step size: constant, proportional to the inverse of the
+ * friction coefficient or to the inverse of the friction coefficient by the
+ * initial relative velocity. The trajectories are not moved on the table, only
+ * the order array is built, so the results can be scattered back to the
+ * original indices.
+ */
+void
+sample_sort (Sample * s,        ///< Sample struct.
+             Equation * eq)     ///< Equation struct.
+{
+  SampleCost *c;
+  long double v;
+  unsigned int i, n;
+#if DEBUG_SAMPLE
+  fprintf (stderr, "sample_sort: start\n");
+#endif
+  n = s->n;
+  c = (SampleCost *) g_malloc (n * sizeof (SampleCost));
+  for (i = 0; i < n; ++i)
+    {
+      c[i].index = i;
+      c[i].cost = s->t[i];
+      if (!s->lambda)
+        continue;
+      switch (eq->size_type)
+        {
+        case 1:
+          c[i].cost *= fabsl (s->lambda[i]);
+          break;
+        case 2:
+          v = fmaxl (fabsl (s->v[0][i] - s->w[0][i]),
+                     fmaxl (fabsl (s->v[1][i] - s->w[1][i]),
+                            fabsl (s->v[2][i])));
+          c[i].cost *= fabsl (s->lambda[i]) * v;
+        }
+    }
+  qsort (c, n, sizeof (SampleCost), sample_cost_compare);
+  s->order = (unsigned int *) g_malloc (n * sizeof (unsigned int));
+  for (i = 0; i < n; ++i)
+    s->order[i] = c[i].index;
+  g_free (c);
+#if DEBUG_SAMPLE
+  fprintf (stderr, "sample_sort: end\n");
+#endif
+}
+
+/**
+ * Function to generate a sample of trajectories.
+ *
+ * The initial conditions, the invariants and the analytical reference solution
+ * of every trajectory are calculated only once, so they can be shared by all
+ * the convergence steps. The sample starts at the offset trajectory index, so
+ * a single trajectory can be regenerated with a sample of one trajectory. With
+ * the sort option, the trajectories are ordered by decreasing predicted cost.
+ * With the batch option, the reference solutions are calculated by batches in
+ * double precision after sampling all the trajectories. With a ready function,
+ * the reference solutions and the sorting are left to the caller, which has
+ * to calculate them by batches with the batch option.
+ */
+void
+sample_init (Sample * s,        ///< Sample struct.
+             Equation * eq,     ///< Equation struct.
+             gsl_rng * rng,     ///< gsl_rng struct.
+             unsigned int n)    ///< number of trajectories.
+{
+  double u[5], shift[5];
+  gsl_qrng *qrng;
+  unsigned long long int t0, tr;
+  unsigned int i, j;
+#if DEBUG_SAMPLE
+  fprintf (stderr, "sample_init: start\n");
+  fprintf (stderr, "sample_init: n=%u\n", n);
+#endif
+  t0 = profile_clock ();
+  tr = profile->time[PROFILE_REFERENCE];
+  sample_alloc (s, eq, n);
+  s->order = NULL;
+  if (s->type == 3)
+    {
+      sample_init_philox (s, eq);
+      goto end;
+    }
+  if (s->seed)
+    gsl_rng_set (rng, s->seed);
+  j = (eq->type) ? 5 : 4;
+  switch (s->type)
+    {
+    case 1:
+      qrng = gsl_qrng_alloc (gsl_qrng_sobol, j);
+      break;
+    case 2:
+      qrng = gsl_qrng_alloc (gsl_qrng_halton, j);
+      break;
+    default:
+      qrng = NULL;
+    }
+  if (qrng && s->scramble)
+    {
+      gsl_rng_set (rng, s->scramble);
+      for (j = 0; j < 5; ++j)
+        shift[j] = gsl_rng_uniform (rng);
+    }
+  else
+    shift[0] = shift[1] = shift[2] = shift[3] = shift[4] = 0.;
+  u[0] = 0.;
+
+  // skipping the trajectories before the offset
+  for (i = 0; i < s->offset; ++i)
+    sample_uniform (s, eq, rng, qrng, shift, u);
+
+  for (i = 0; i < n; ++i)
+    {
+      sample_uniform (s, eq, rng, qrng, shift, u);
+      equation_init (eq, u);
+      sample_store (s, eq, i);
+    }
+  if (qrng)
+    gsl_qrng_free (qrng);
+end:
+  if (s->batch && !s->ready)
+    sample_solve_list (s, eq, NULL, n);
+  if (s->sort && !s->ready)
+    sample_sort (s, eq);
+
+  // without a pipeline, the reference solutions are calculated on this thread
+  t0 = profile_clock () - t0;
+  if (!s->ready)
+    t0 -= profile->time[PROFILE_REFERENCE] - tr;
+  profile_add (PROFILE_SAMPLE, t0);
+#if DEBUG_SAMPLE
+  fprintf (stderr, "sample_init: end\n");
+#endif
+  return;
+}
+
+/**
+ * Function to load the initial conditions and the invariants of a trajectory
+ *   on an Equation struct.
+ */
+void
+sample_load (Sample * s,        ///< Sample struct.
+             Equation * eq,     ///< Equation struct.
+             unsigned int i)    ///< trajectory index.
+{
+#if DEBUG_SAMPLE
+  fprintf (stderr, "sample_load: start\n");
+  fprintf (stderr, "sample_load: i=%u\n", i);
+#endif
+  eq->v[0] = s->v[0][i];
+  eq->v[1] = s->v[1][i];
+  eq->v[2] = s->v[2][i];
+  eq->w[0] = s->w[0][i];
+  eq->w[1] = s->w[1][i];
+  switch (eq->type)
+    {
+    case 2:
+      eq->gl = s->gl[i];
+      eq->g_l = s->g_l[i];
+      eq->alpha = s->alpha[i];
+      eq->tc = eq->alpha / eq->gl;
+      eq->calpha = s->calpha[i];
+      // fall through
+    case 1:
+    case 3:
+      eq->lambda = s->lambda[i];
+      eq->li = 1.L / eq->lambda;
+    }
+#if DEBUG_SAMPLE
+  fprintf (stderr, "sample_load: end\n");
+#endif
+}
+
+/**
+ * Function to get the reference solution of a trajectory.
+ *
+ * \return reference final time.
+ */
+long double
+sample_reference (Sample * s,   ///< Sample struct.
+                  unsigned int i,       ///< trajectory index.
+                  long double *r0,      ///< reference position vector.
+                  long double *r1)      ///< reference velocity vector.
+{
+  r0[0] = s->r0[0][i];
+  r0[1] = s->r0[1][i];
+  r0[2] = s->r0[2][i];
+  r1[0] = s->r1[0][i];
+  r1[1] = s->r1[1][i];
+  r1[2] = s->r1[2][i];
+  return s->t[i];
+}
+
+/**
+ * Function to free the memory used by a Sample struct.
+ */
+void
+sample_delete (Sample * s)      ///< Sample struct.
+{
+#if DEBUG_SAMPLE
+  fprintf (stderr, "sample_delete: start\n");
+#endif
+  g_free (s->order);
+  g_free (s->data);
+#if DEBUG_SAMPLE
+  fprintf (stderr, "sample_delete: end\n");
+#endif
+}
@@ -0,0 +1,93 @@
+/*
+Ballistic: a software to benchmark ballistic models.
+
+AUTHORS: Javier Burguete Tolosa.
+
+Copyright 2018, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+/**
+ * \file sample.h
+ * \brief Header file to define the trajectories sample data and functions.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2018.
+ */
+#ifndef SAMPLE__H
+#define SAMPLE__H 1
+
+#define SAMPLE_BATCH 1024
+///< number of trajectories of a batch on vectorized sampling.
+
+/**
+ * \struct Sample
+ * \brief struct to define a sample of trajectories.
+ *
+ * The initial conditions, the invariants and the reference solution of the
+ * trajectories are stored as a table of columns packed on a single memory
+ * block. Only the columns required by the equation type are allocated, the
+ * other column pointers are NULL. The invariants are stored only if they need
+ * transcendental functions, the divisions are recalculated on loading.
+ */
+typedef struct
+{
+  long double *data;            ///< packed memory block of the columns.
+  long double *v[3];            ///< columns of initial velocity components.
+  long double *w[2];            ///< columns of wind velocity components.
+  long double *lambda;          ///< column of friction coefficients.
+  long double *gl;              ///< column of square roots of g by lambda.
+  long double *g_l;             ///< column of square roots of g by 1/lambda.
+  long double *alpha;           ///< column of alpha angles.
+  long double *calpha;          ///< column of cosines of alpha.
+  long double *r0[3];           ///< columns of reference position components.
+  long double *r1[3];           ///< columns of reference velocity components.
+  long double *t;               ///< column of reference final times.
+  unsigned int *order;
+  ///< array of trajectory indices sorted by decreasing cost (NULL: unsorted).
+  void (*ready) (void *data, unsigned int i);
+  ///< function called when a trajectory is sampled (NULL: none).
+  void *data_ready;             ///< data of the ready function.
+  unsigned int n;               ///< number of trajectories.
+  unsigned int ncolumns;        ///< number of columns.
+  unsigned int type;
+  ///< sampling type (0: pseudo-random, 1: Sobol, 2: Halton, 3: Philox).
+  unsigned int scramble;        ///< scramble seed (0: no scrambling).
+  unsigned int seed;            ///< pseudo-random numbers seed.
+  unsigned int offset;          ///< index of the first trajectory.
+  unsigned int sort;            ///< 1 on sorting the trajectories by cost.
+  unsigned int batch;
+  ///< 1 on calculating the reference solutions by batches.
+} Sample;
+
+int sample_read_xml (Sample * s, xmlNode * node);
+void sample_solve (Sample * s, Equation * eq, unsigned int i);
+void sample_solve_list (Sample * s, Equation * eq, const unsigned int *list,
+                        unsigned int n);
+void sample_sort (Sample * s, Equation * eq);
+void sample_init (Sample * s, Equation * eq, gsl_rng * rng, unsigned int n);
+void sample_load (Sample * s, Equation * eq, unsigned int i);
+long double sample_reference (Sample * s, unsigned int i, long double *r0,
+                              long double *r1);
+void sample_delete (Sample * s);
+
+#endif
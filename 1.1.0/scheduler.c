@@ -0,0 +1,149 @@
+/*
+Ballistic: a software to benchmark ballistic models.
+
+AUTHORS: Javier Burguete Tolosa.
+
+Copyright 2018, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+/**
+ * \file scheduler.c
+ * \brief Source file to define the work-stealing scheduler functions.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2018.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <glib.h>
+#include "scheduler.h"
+
+#define DEBUG_SCHEDULER 0       ///< macro to debug the scheduler functions.
+
+/**
+ * Function to init a work-stealing scheduler.
+ *
+ * The indices [0, n) are initially divided in nthreads contiguous ranges.
+ */
+void
+scheduler_init (Scheduler * s,  ///< Scheduler struct.
+                unsigned int n, ///< number of indices.
+                unsigned int nthreads)  ///< number of threads.
+{
+  unsigned int i;
+#if DEBUG_SCHEDULER
+  fprintf (stderr, "scheduler_init: start\n");
+#endif
+  s->nthreads = nthreads;
+  s->range
+    = (SchedulerRange *) g_malloc (nthreads * sizeof (SchedulerRange));
+  for (i = 0; i < nthreads; ++i)
+    {
+      g_mutex_init (&s->range[i].mutex);
+      s->range[i].begin = (unsigned int) ((unsigned long int) n * i
+                                          / nthreads);
+      s->range[i].end = (unsigned int) ((unsigned long int) n * (i + 1)
+                                        / nthreads);
+    }
+#if DEBUG_SCHEDULER
+  fprintf (stderr, "scheduler_init: end\n");
+#endif
+}
+
+/**
+ * Function to take a chunk of the own range of a thread.
+ *
+ * \return 1 on success, 0 if the range is empty.
+ */
+static inline int
+scheduler_take (SchedulerRange * r,     ///< SchedulerRange struct.
+                unsigned int *begin,    ///< pointer to the first index.
+                unsigned int *end)      ///< pointer to the index after the last.
+{
+  unsigned int n;
+  g_mutex_lock (&r->mutex);
+  n = r->end - r->begin;
+  if (n)
+    {
+      n = n / SCHEDULER_SPLIT;
+      if (!n)
+        n = 1;
+      *begin = r->begin;
+      *end = r->begin += n;
+    }
+  g_mutex_unlock (&r->mutex);
+  return n != 0;
+}
+
+/**
+ * Function to get the next chunk of indices of a thread.
+ *
+ * \return 1 on success, 0 if there are no more indices.
+ */
+int
+scheduler_next (Scheduler * s,  ///< Scheduler struct.
+                unsigned int thread,    ///< thread number.
+                unsigned int *begin,    ///< pointer to the first index.
+                unsigned int *end)      ///< pointer to the index after the last.
+{
+  SchedulerRange *r, *v;
+  unsigned int i, b, e;
+  r = s->range + thread;
+  if (scheduler_take (r, begin, end))
+    return 1;
+  for (i = 1; i < s->nthreads; ++i)
+    {
+      v = s->range + (thread + i) % s->nthreads;
+      g_mutex_lock (&v->mutex);
+      e = v->end;
+      b = v->begin + (e - v->begin) / 2;
+      v->end = b;
+      g_mutex_unlock (&v->mutex);
+      if (b < e)
+        {
+#if DEBUG_SCHEDULER
+          fprintf (stderr, "scheduler_next: thread %u steals [%u,%u)\n",
+                   thread, b, e);
+#endif
+          g_mutex_lock (&r->mutex);
+          r->begin = b;
+          r->end = e;
+          g_mutex_unlock (&r->mutex);
+          if (scheduler_take (r, begin, end))
+            return 1;
+        }
+    }
+  return 0;
+}
+
+/**
+ * Function to free the memory used by a work-stealing scheduler.
+ */
+void
+scheduler_delete (Scheduler * s)        ///< Scheduler struct.
+{
+  unsigned int i;
+  for (i = 0; i < s->nthreads; ++i)
+    g_mutex_clear (&s->range[i].mutex);
+  g_free (s->range);
+}
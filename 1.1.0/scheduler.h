@@ -0,0 +1,74 @@
+/*
+Ballistic: a software to benchmark ballistic models.
+
+AUTHORS: Javier Burguete Tolosa.
+
+Copyright 2018, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+/**
+ * \file scheduler.h
+ * \brief Header file to define the work-stealing scheduler data and functions.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2018.
+ */
+#ifndef SCHEDULER__H
+#define SCHEDULER__H 1
+
+#define SCHEDULER_SPLIT 4
+///< inverse of the fraction of the remaining range taken by a chunk.
+
+/**
+ * \struct SchedulerRange
+ * \brief struct to define the range of indices owned by a thread.
+ */
+typedef struct
+{
+  GMutex mutex;                 ///< mutex to access to the range.
+  unsigned int begin;           ///< first index of the range.
+  unsigned int end;             ///< index after the last index of the range.
+  char pad[64];                 ///< padding to avoid false sharing.
+} SchedulerRange;
+
+/**
+ * \struct Scheduler
+ * \brief struct to define a work-stealing scheduler of a loop of indices.
+ *
+ * Every thread takes chunks from the begin of its own range of indices. The
+ * chunk size is the SCHEDULER_SPLIT-th part of the remaining range, so the
+ * chunks shrink at the end of the loop. A thread with an empty range steals the
+ * upper half of the range of another thread.
+ */
+typedef struct
+{
+  SchedulerRange *range;        ///< array of ranges.
+  unsigned int nthreads;        ///< number of threads.
+} Scheduler;
+
+void scheduler_init (Scheduler * s, unsigned int n, unsigned int nthreads);
+int scheduler_next (Scheduler * s, unsigned int thread, unsigned int *begin,
+                    unsigned int *end);
+void scheduler_delete (Scheduler * s);
+
+#endif
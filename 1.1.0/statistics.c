@@ -0,0 +1,410 @@
+/*
+Ballistic: a software to benchmark ballistic models.
+
+AUTHORS: Javier Burguete Tolosa.
+
+Copyright 2018, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+/**
+ * \file statistics.c
+ * \brief Source file to define the streaming statistics functions.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2018.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "config.h"
+#include "statistics.h"
+
+#define DEBUG_STATISTICS 0      ///< macro to debug the statistics functions.
+
+/**
+ * Function to propagate the carries of an exact accumulator.
+ *
+ * After the propagation all the digits are in [0, 2^32).
+ */
+static inline void
+accumulator_carry (Accumulator * a)     ///< Accumulator struct.
+{
+  long long int c;
+  unsigned int i;
+  for (i = 0, c = 0ll; i < ACCUMULATOR_DIGITS; ++i)
+    {
+      c += a->digit[i];
+      a->digit[i] = c & 0xffffffffll;
+      c >>= 32;
+    }
+  a->ncarry = 0;
+}
+
+/**
+ * Function to init an exact accumulator.
+ */
+void
+accumulator_init (Accumulator * a)      ///< Accumulator struct.
+{
+  memset (a, 0, sizeof (Accumulator));
+}
+
+/**
+ * Function to add a non-negative number to an exact accumulator.
+ */
+void
+accumulator_add (Accumulator * a,       ///< Accumulator struct.
+                 long double x) ///< number.
+{
+  unsigned long long int m;
+  int e, p, k;
+  if (!isfinite (x) || x >= 0x1p1000L)
+    {
+      a->overflow += x;
+      return;
+    }
+  if (x <= 0.L)
+    return;
+  // x = m * 2^(e - 64) with m a 64 bits integer
+  m = (unsigned long long int) ldexpl (frexpl (x, &e), 64);
+  p = e - 64 + ACCUMULATOR_BIAS;
+  if (p < 0)
+    {
+      if (p <= -64)
+        return;
+      m >>= -p;
+      p = 0;
+    }
+  k = p >> 5;
+  p &= 31;
+  a->digit[k] += (long long int) ((m << p) & 0xffffffffull);
+  a->digit[k + 1] += (long long int) ((m >> (32 - p)) & 0xffffffffull);
+  if (p)
+    a->digit[k + 2] += (long long int) (m >> (64 - p));
+  if (++a->ncarry >= ACCUMULATOR_CARRY)
+    accumulator_carry (a);
+}
+
+/**
+ * Function to merge two exact accumulators.
+ */
+void
+accumulator_merge (Accumulator * a,     ///< Accumulator struct.
+                   const Accumulator * a2)      ///< Accumulator struct to add.
+{
+  unsigned int i;
+  if (a->ncarry + a2->ncarry >= ACCUMULATOR_CARRY)
+    accumulator_carry (a);
+  for (i = 0; i < ACCUMULATOR_DIGITS; ++i)
+    a->digit[i] += a2->digit[i];
+  a->overflow += a2->overflow;
+  a->ncarry += a2->ncarry + 1;
+}
+
+/**
+ * Function to get the value of an exact accumulator.
+ *
+ * \return value rounded to long double.
+ */
+long double
+accumulator_value (Accumulator * a)     ///< Accumulator struct.
+{
+  long double x;
+  unsigned int i;
+  accumulator_carry (a);
+  for (i = 0, x = 0.L; i < ACCUMULATOR_DIGITS; ++i)
+    x += ldexpl ((long double) a->digit[i], 32 * i - ACCUMULATOR_BIAS);
+  return x + a->overflow;
+}
+
+/**
+ * Function to init the streaming moments.
+ */
+void
+statistics_init (Statistics * s)        ///< Statistics struct.
+{
+  accumulator_init (&s->sum2);
+  s->mean = s->m2 = s->max = 0.L;
+  s->n = 0l;
+}
+
+/**
+ * Function to add a value to the streaming moments.
+ */
+CPU_DISPATCH void
+statistics_add (Statistics * s, ///< Statistics struct.
+                long double x)  ///< value.
+{
+  long double d;
+  ++s->n;
+  d = x - s->mean;
+  s->mean += d / s->n;
+  s->m2 += d * (x - s->mean);
+  accumulator_add (&s->sum2, x * x);
+  s->max = fmaxl (s->max, x);
+}
+
+/**
+ * Function to merge two streaming moments (Chan et al. algorithm).
+ */
+void
+statistics_merge (Statistics * s,       ///< Statistics struct.
+                  const Statistics * s2)        ///< Statistics struct to add.
+{
+  long double d;
+  unsigned long int n;
+  if (!s2->n)
+    return;
+  n = s->n + s2->n;
+  d = s2->mean - s->mean;
+  s->mean += d * s2->n / n;
+  s->m2 += s2->m2 + d * d * s->n * s2->n / n;
+  accumulator_merge (&s->sum2, &s2->sum2);
+  s->max = fmaxl (s->max, s2->max);
+  s->n = n;
+}
+
+/**
+ * Function to get the sample variance of the streaming moments.
+ *
+ * \return sample variance.
+ */
+long double
+statistics_variance (Statistics * s)    ///< Statistics struct.
+{
+  if (s->n < 2)
+    return 0.L;
+  return s->m2 / (s->n - 1);
+}
+
+/**
+ * Function to get the root mean square of the streaming moments.
+ *
+ * \return root mean square.
+ */
+long double
+statistics_rms (Statistics * s) ///< Statistics struct.
+{
+  if (!s->n)
+    return 0.L;
+  return sqrtl (accumulator_value (&s->sum2) / s->n);
+}
+
+/**
+ * Function to init the streaming covariance.
+ */
+void
+covariance_init (Covariance * c)        ///< Covariance struct.
+{
+  c->mx = c->my = c->sxx = c->syy = c->sxy = 0.L;
+  c->n = 0l;
+}
+
+/**
+ * Function to add a pair of values to the streaming covariance.
+ */
+CPU_DISPATCH void
+covariance_add (Covariance * c, ///< Covariance struct.
+                long double x,  ///< 1st value.
+                long double y)  ///< 2nd value.
+{
+  long double dx, dy;
+  ++c->n;
+  dx = x - c->mx;
+  dy = y - c->my;
+  c->mx += dx / c->n;
+  c->my += dy / c->n;
+  c->sxx += dx * (x - c->mx);
+  c->syy += dy * (y - c->my);
+  c->sxy += dx * (y - c->my);
+}
+
+/**
+ * Function to merge two streaming covariances.
+ */
+void
+covariance_merge (Covariance * c,       ///< Covariance struct.
+                  const Covariance * c2)        ///< Covariance struct to add.
+{
+  long double dx, dy, k;
+  unsigned long int n;
+  if (!c2->n)
+    return;
+  n = c->n + c2->n;
+  dx = c2->mx - c->mx;
+  dy = c2->my - c->my;
+  k = (long double) c->n * c2->n / n;
+  c->mx += dx * c2->n / n;
+  c->my += dy * c2->n / n;
+  c->sxx += c2->sxx + dx * dx * k;
+  c->syy += c2->syy + dy * dy * k;
+  c->sxy += c2->sxy + dx * dy * k;
+  c->n = n;
+}
+
+/**
+ * Function to get the correlation coefficient of the streaming covariance.
+ *
+ * \return correlation coefficient.
+ */
+long double
+covariance_correlation (Covariance * c) ///< Covariance struct.
+{
+  if (c->sxx <= 0.L || c->syy <= 0.L)
+    return 0.L;
+  return c->sxy / sqrtl (c->sxx * c->syy);
+}
+
+/**
+ * Function to init a quantiles sketch.
+ */
+void
+sketch_init (Sketch * s)        ///< Sketch struct.
+{
+  memset (s, 0, sizeof (Sketch));
+}
+
+/**
+ * Function to add a value to a quantiles sketch.
+ */
+void
+sketch_add (Sketch * s,         ///< Sketch struct.
+            long double x)      ///< value.
+{
+  double k;
+  ++s->n;
+  if (x < SKETCH_MIN)
+    {
+      ++s->nzero;
+      return;
+    }
+  k = ceil (log (x / SKETCH_MIN)
+            / log ((1. + SKETCH_ACCURACY) / (1. - SKETCH_ACCURACY)));
+  if (k >= SKETCH_BUCKETS)
+    k = SKETCH_BUCKETS - 1;
+  ++s->bucket[(unsigned int) k];
+}
+
+/**
+ * Function to merge two quantiles sketches.
+ */
+void
+sketch_merge (Sketch * s,       ///< Sketch struct.
+              const Sketch * s2)        ///< Sketch struct to add.
+{
+  unsigned int i;
+  for (i = 0; i < SKETCH_BUCKETS; ++i)
+    s->bucket[i] += s2->bucket[i];
+  s->nzero += s2->nzero;
+  s->n += s2->n;
+}
+
+/**
+ * Function to get a quantile of a sketch.
+ *
+ * \return quantile value.
+ */
+long double
+sketch_quantile (Sketch * s,    ///< Sketch struct.
+                 long double q) ///< quantile probability.
+{
+  long double gamma;
+  unsigned long int rank, n;
+  unsigned int i;
+  if (!s->n)
+    return 0.L;
+  rank = (unsigned long int) (q * (s->n - 1));
+  n = s->nzero;
+  if (rank < n)
+    return 0.L;
+  for (i = 0; i < SKETCH_BUCKETS - 1; ++i)
+    {
+      n += s->bucket[i];
+      if (rank < n)
+        break;
+    }
+  gamma = (1.L + SKETCH_ACCURACY) / (1.L - SKETCH_ACCURACY);
+#if DEBUG_STATISTICS
+  fprintf (stderr, "sketch_quantile: q=%Lg bucket=%u\n", q, i);
+#endif
+  return 2.L * SKETCH_MIN * powl (gamma, i) / (gamma + 1.L);
+}
+
+/**
+ * Function to init a high dynamic range histogram.
+ */
+void
+histogram_init (Histogram * h)  ///< Histogram struct.
+{
+  memset (h, 0, sizeof (Histogram));
+}
+
+/**
+ * Function to add a value to a high dynamic range histogram.
+ */
+void
+histogram_add (Histogram * h,   ///< Histogram struct.
+               unsigned long long int x)        ///< value.
+{
+  unsigned int k, shift;
+  ++h->n;
+  if (x < HISTOGRAM_SUB)
+    {
+      ++h->bucket[x];
+      return;
+    }
+  shift = 63 - __builtin_clzll (x) - HISTOGRAM_BITS;
+  k = (shift + 1) * HISTOGRAM_SUB + (unsigned int) (x >> shift)
+    - HISTOGRAM_SUB;
+  ++h->bucket[k];
+}
+
+/**
+ * Function to merge two high dynamic range histograms.
+ */
+void
+histogram_merge (Histogram * h, ///< Histogram struct.
+                 const Histogram * h2)  ///< Histogram struct to add.
+{
+  unsigned int i;
+  for (i = 0; i < HISTOGRAM_BUCKETS; ++i)
+    h->bucket[i] += h2->bucket[i];
+  h->n += h2->n;
+}
+
+/**
+ * Function to get the lower bound of a bucket of a high dynamic range
+ *   histogram.
+ *
+ * \return lowest value of the bucket (the next bucket lower bound is the upper
+ *   bound).
+ */
+unsigned long long int
+histogram_lower (unsigned int i)        ///< bucket index.
+{
+  if (i < HISTOGRAM_SUB)
+    return i;
+  return (unsigned long long int) (HISTOGRAM_SUB + i % HISTOGRAM_SUB)
+    << (i / HISTOGRAM_SUB - 1);
+}
@@ -0,0 +1,157 @@
+/*
+Ballistic: a software to benchmark ballistic models.
+
+AUTHORS: Javier Burguete Tolosa.
+
+Copyright 2018, AUTHORS.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+/**
+ * \file statistics.h
+ * \brief Header file to define the streaming statistics data and functions.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2018.
+ */
+#ifndef STATISTICS__H
+#define STATISTICS__H 1
+
+#define ACCUMULATOR_BIAS 1088
+///< bit position of the unit on an exact accumulator.
+#define ACCUMULATOR_DIGITS 72   ///< number of 32 bits digits of an accumulator.
+#define ACCUMULATOR_CARRY 0x40000000u
+///< maximum number of additions of an accumulator without carry propagation.
+#define SKETCH_ACCURACY 0.01
+///< relative accuracy of the quantiles of a sketch.
+#define SKETCH_BUCKETS 7168     ///< number of buckets of a sketch.
+#define SKETCH_MIN 1e-30        ///< minimum non-zero value of a sketch.
+#define HISTOGRAM_BITS 4
+///< number of bits of the sub-buckets of an octave of a histogram.
+#define HISTOGRAM_SUB (1u << HISTOGRAM_BITS)
+///< number of sub-buckets of an octave of a histogram.
+#define HISTOGRAM_BUCKETS ((65u - HISTOGRAM_BITS) * HISTOGRAM_SUB)
+///< number of buckets of a histogram.
+
+/**
+ * \struct Accumulator
+ * \brief struct to define an exact accumulator of non-negative numbers.
+ *
+ * The numbers are added exactly on a fixed point number of 32 bits digits
+ * stored on 64 bits integers, with the unit at the ACCUMULATOR_BIAS bit. The
+ * sum does not depend on the order of the additions and merges, so the results
+ * are bitwise reproducible with any number of threads or shards. Numbers lower
+ * than 2^(-ACCUMULATOR_BIAS) are truncated.
+ */
+typedef struct
+{
+  long long int digit[ACCUMULATOR_DIGITS];      ///< array of digits.
+  long double overflow;         ///< sum of the not finite numbers.
+  unsigned int ncarry;          ///< number of additions without carry.
+} Accumulator;
+
+/**
+ * \struct Statistics
+ * \brief struct to define the streaming moments of a variable.
+ *
+ * The mean and the variance are updated with the Welford algorithm and the sum
+ * of squares is exact, so the root mean square is accurate and reproducible
+ * with any number of values.
+ */
+typedef struct
+{
+  Accumulator sum2;             ///< sum of squares.
+  long double mean;             ///< mean value.
+  long double m2;               ///< sum of squares of the deviations.
+  long double max;              ///< maximum value.
+  unsigned long int n;          ///< number of values.
+} Statistics;
+
+/**
+ * \struct Covariance
+ * \brief struct to define the streaming covariance of two variables.
+ */
+typedef struct
+{
+  long double mx;               ///< mean of the 1st variable.
+  long double my;               ///< mean of the 2nd variable.
+  long double sxx;              ///< sum of squares of the 1st deviations.
+  long double syy;              ///< sum of squares of the 2nd deviations.
+  long double sxy;              ///< sum of products of the deviations.
+  unsigned long int n;          ///< number of value pairs.
+} Covariance;
+
+/**
+ * \struct Sketch
+ * \brief struct to define a quantiles sketch of a positive variable.
+ *
+ * The values are counted on logarithmic buckets of ratio
+ * (1+SKETCH_ACCURACY)/(1-SKETCH_ACCURACY), so any quantile is got with a
+ * relative error lower than SKETCH_ACCURACY using constant memory. Two sketches
+ * are merged adding the counts of the buckets.
+ */
+typedef struct
+{
+  unsigned long int bucket[SKETCH_BUCKETS];     ///< array of bucket counts.
+  unsigned long int nzero;      ///< number of values lower than SKETCH_MIN.
+  unsigned long int n;          ///< number of values.
+} Sketch;
+
+/**
+ * \struct Histogram
+ * \brief struct to define a high dynamic range histogram of a counter.
+ *
+ * The values lower than HISTOGRAM_SUB are counted exactly and every octave
+ * [2^k, 2^(k+1)) of the greater values is divided in HISTOGRAM_SUB linear
+ * buckets, so the relative width of a bucket is lower than 1/HISTOGRAM_SUB for
+ * all the 64 bits values. Two histograms are merged adding the counts of the
+ * buckets.
+ */
+typedef struct
+{
+  unsigned long int bucket[HISTOGRAM_BUCKETS];  ///< array of bucket counts.
+  unsigned long int n;          ///< number of values.
+} Histogram;
+
+void accumulator_init (Accumulator * a);
+void accumulator_add (Accumulator * a, long double x);
+void accumulator_merge (Accumulator * a, const Accumulator * a2);
+long double accumulator_value (Accumulator * a);
+void statistics_init (Statistics * s);
+void statistics_add (Statistics * s, long double x);
+void statistics_merge (Statistics * s, const Statistics * s2);
+long double statistics_variance (Statistics * s);
+long double statistics_rms (Statistics * s);
+void covariance_init (Covariance * c);
+void covariance_add (Covariance * c, long double x, long double y);
+void covariance_merge (Covariance * c, const Covariance * c2);
+long double covariance_correlation (Covariance * c);
+void sketch_init (Sketch * s);
+void sketch_add (Sketch * s, long double x);
+void sketch_merge (Sketch * s, const Sketch * s2);
+long double sketch_quantile (Sketch * s, long double q);
+void histogram_init (Histogram * h);
+void histogram_add (Histogram * h, unsigned long long int x);
+void histogram_merge (Histogram * h, const Histogram * h2);
+unsigned long long int histogram_lower (unsigned int i);
+
+#endif
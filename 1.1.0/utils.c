@@ -85,6 +85,44 @@ distance (long double *r1,      ///< 1st vector.
   return d;
 }
 
+/**
+ * Function to calculate the sine and the cosine of a batch of angles in
+ *   revolutions.
+ *
+ * This function calculates \f$\sin\left(2\,\pi\,u\right)\f$ and
+ * \f$\cos\left(2\,\pi\,u\right)\f$ in double precision with
+ * \f$u\in[0,\;1)\f$. The argument is reduced to
+ * \f$x\in\left[-\pi/4,\;\pi/4\right]\f$ and the quadrant, then Taylor
+ * polynomials are evaluated and the results are selected without branches, so
+ * the loop can be vectorized.
+ */
+CPU_DISPATCH void
+sincos_2pi (const double *u,    ///< array of angles in revolutions.
+            double *s,          ///< array of sines.
+            double *c,          ///< array of cosines.
+            unsigned int n)     ///< number of angles.
+{
+  double q, x, x2, sx, cx;
+  unsigned int i;
+  int k;
+  for (i = 0; i < n; ++i)
+    {
+      k = (int) (4. * u[i] + 0.5);
+      q = (double) k;
+      x = 2. * M_PI * (u[i] - 0.25 * q);
+      x2 = x * x;
+      sx = x * (1. + x2 * (-1. / 6. + x2 * (1. / 120. + x2 * (-1. / 5040.
+           + x2 * (1. / 362880. + x2 * (-1. / 39916800. + x2 * (1.
+           / 6227020800. + x2 * (-1. / 1307674368000.))))))));
+      cx = 1. + x2 * (-0.5 + x2 * (1. / 24. + x2 * (-1. / 720. + x2 * (1.
+           / 40320. + x2 * (-1. / 3628800. + x2 * (1. / 479001600. + x2
+           * (-1. / 87178291200. + x2 * (1. / 20922789888000.))))))));
+      k &= 3;
+      s[i] = (k == 0) ? sx : (k == 1) ? cx : (k == 2) ? -sx : -cx;
+      c[i] = (k == 0) ? cx : (k == 1) ? -sx : (k == 2) ? -cx : sx;
+    }
+}
+
 /**
  * Function to calculate the solution of a reduced 2nd order equation.
  *
@@ -40,6 +40,7 @@ extern char *error_message;
 
 void error_add (const char *message);
 long double distance (long double *r1, long double *r2);
+void sincos_2pi (const double *u, double *s, double *c, unsigned int n);
 long double solve_quadratic_reduced (long double a, long double b,
                                      long double x1, long double x2);
 long double solve_quadratic (long double a, long double b, long double c,